@@ -175,7 +175,7 @@ class BitstreamCursor {
   /// intentionally defined to follow the word size of the host machine for
   /// efficiency.  We use word_t in places that are aware of this to make it
   /// perfectly explicit what is going on.
-  typedef uint32_t word_t;
+  typedef size_t word_t;
   word_t CurWord;
 
   /// BitsInCurWord - This is the number of bits in CurWord that are valid. This
@@ -341,6 +341,31 @@ public:
   }
 
 
+private:
+  /// fillCurWord - Refill CurWord with the next word of the stream.  Bitcode
+  /// is only guaranteed to be a multiple of 32 bits long, so when a full
+  /// 64-bit word is not available the last 32 bits are read on their own.
+  void fillCurWord() {
+    StreamableMemoryObject &Bytes = BitStream->getBitcodeBytes();
+    uint8_t Array[sizeof(word_t)] = {0};
+    unsigned BytesRead = sizeof(word_t);
+    if (Bytes.readBytes(NextChar, sizeof(word_t), Array) < 0 &&
+        sizeof(word_t) > 4) {
+      BytesRead = 4;
+      Bytes.readBytes(NextChar, BytesRead, Array);
+    }
+
+    // Handle big-endian byte-swapping if necessary.
+    support::detail::packed_endian_specific_integral
+      <word_t, support::little, support::unaligned> EndianValue;
+    memcpy(&EndianValue, Array, sizeof(Array));
+
+    CurWord = EndianValue;
+    NextChar += BytesRead;
+    BitsInCurWord = BytesRead*8;
+  }
+
+public:
   uint32_t Read(unsigned NumBits) {
     assert(NumBits && NumBits <= 32 &&
            "Cannot return zero or more than 32 bits!");
@@ -361,35 +386,23 @@ public:
     }
 
     uint32_t R = uint32_t(CurWord);
+    unsigned BitsUsed = BitsInCurWord;
 
     // Read the next word from the stream.
-    uint8_t Array[sizeof(word_t)] = {0};
-
-    BitStream->getBitcodeBytes().readBytes(NextChar, sizeof(Array), Array);
-
-    // Handle big-endian byte-swapping if necessary.
-    support::detail::packed_endian_specific_integral
-      <word_t, support::little, support::unaligned> EndianValue;
-    memcpy(&EndianValue, Array, sizeof(Array));
-
-    CurWord = EndianValue;
-
-    NextChar += sizeof(word_t);
+    fillCurWord();
 
-    // Extract NumBits-BitsInCurWord from what we just read.
-    unsigned BitsLeft = NumBits-BitsInCurWord;
+    // Extract NumBits-BitsUsed from what we just read.  BitsLeft is in the
+    // range [1..32], and the refill always provides at least 32 bits.
+    unsigned BitsLeft = NumBits-BitsUsed;
+    R |= (uint32_t(CurWord) & (~0U >> (32-BitsLeft))) << BitsUsed;
 
-    // Be careful here, BitsLeft is in the range [1..32]/[1..64] inclusive.
-    R |= uint32_t((CurWord & (word_t(~0ULL) >> (sizeof(word_t)*8-BitsLeft)))
-                    << BitsInCurWord);
-
-    // BitsLeft bits have just been used up from CurWord.  BitsLeft is in the
-    // range [1..32]/[1..64] so be careful how we shift.
+    // BitsLeft bits have just been used up from CurWord.  A 32-bit word can
+    // be consumed entirely, so be careful how we shift.
     if (BitsLeft != sizeof(word_t)*8)
       CurWord >>= BitsLeft;
     else
       CurWord = 0;
-    BitsInCurWord = sizeof(word_t)*8-BitsLeft;
+    BitsInCurWord -= BitsLeft;
     return R;
   }
 
@@ -402,40 +415,40 @@ public:
 
   uint32_t ReadVBR(unsigned NumBits) {
     uint32_t Piece = Read(NumBits);
-    if ((Piece & (1U << (NumBits-1))) == 0)
+    const uint32_t HiBit = 1U << (NumBits-1);
+    if ((Piece & HiBit) == 0)
       return Piece;
 
-    uint32_t Result = 0;
-    unsigned NextBit = 0;
-    while (1) {
-      Result |= (Piece & ((1U << (NumBits-1))-1)) << NextBit;
-
-      if ((Piece & (1U << (NumBits-1))) == 0)
-        return Result;
-
-      NextBit += NumBits-1;
+    // The chunk masks are computed once, so each further chunk costs a read,
+    // an or and a test.
+    const uint32_t Mask = HiBit-1;
+    uint32_t Result = Piece & Mask;
+    unsigned NextBit = NumBits-1;
+    do {
       Piece = Read(NumBits);
-    }
+      Result |= (Piece & Mask) << NextBit;
+      NextBit += NumBits-1;
+    } while (Piece & HiBit);
+    return Result;
   }
 
   // ReadVBR64 - Read a VBR that may have a value up to 64-bits in size.  The
   // chunk size of the VBR must still be <= 32 bits though.
   uint64_t ReadVBR64(unsigned NumBits) {
     uint32_t Piece = Read(NumBits);
-    if ((Piece & (1U << (NumBits-1))) == 0)
+    const uint32_t HiBit = 1U << (NumBits-1);
+    if ((Piece & HiBit) == 0)
       return uint64_t(Piece);
 
-    uint64_t Result = 0;
-    unsigned NextBit = 0;
-    while (1) {
-      Result |= uint64_t(Piece & ((1U << (NumBits-1))-1)) << NextBit;
-
-      if ((Piece & (1U << (NumBits-1))) == 0)
-        return Result;
-
-      NextBit += NumBits-1;
+    const uint32_t Mask = HiBit-1;
+    uint64_t Result = Piece & Mask;
+    unsigned NextBit = NumBits-1;
+    do {
       Piece = Read(NumBits);
-    }
+      Result |= uint64_t(Piece & Mask) << NextBit;
+      NextBit += NumBits-1;
+    } while (Piece & HiBit);
+    return Result;
   }
 
 private:
@@ -527,6 +540,11 @@ private:
   void readAbbreviatedField(const BitCodeAbbrevOp &Op,
                             SmallVectorImpl<uint64_t> &Vals);
   void skipAbbreviatedField(const BitCodeAbbrevOp &Op);
+  bool canReadFields(uint64_t NumElts, unsigned MinWidth);
+  void readVBR6Array(unsigned NumElts, SmallVectorImpl<uint64_t> &Vals);
+  void readArray(const BitCodeAbbrevOp &EltEnc, unsigned NumElts,
+                 SmallVectorImpl<uint64_t> &Vals);
+  void skipArray(const BitCodeAbbrevOp &EltEnc, unsigned NumElts);
 
 public:
 
@@ -267,6 +267,17 @@ public:
     BlockScope.pop_back();
   }
 
+  /// EmitBlocks - Append blocks encoded by another BitstreamWriter.  Both
+  /// writers must be at a 32-bit boundary with the same code size in effect,
+  /// and the blocks must have been encoded with the same blockinfo
+  /// abbreviations; block sizes are relative, so the bits do not depend on
+  /// where they end up.
+  void EmitBlocks(StringRef Blocks) {
+    assert(CurBit == 0 && "Blocks must start at a 32-bit boundary");
+    assert((Blocks.size() & 3) == 0 && "Blocks must end at a 32-bit boundary");
+    Out.append(Blocks.begin(), Blocks.end());
+  }
+
   //===--------------------------------------------------------------------===//
   // Record Emission
   //===--------------------------------------------------------------------===//
@@ -62,6 +62,11 @@ namespace llvm {
     ///
     VNInfo::Allocator VNInfoAllocator;
 
+    /// Allocators used by the worker threads of computeVirtRegsInParallel.
+    /// They own VNInfos of the intervals they computed, so they live as long
+    /// as VNInfoAllocator.
+    SmallVector<VNInfo::Allocator*, 4> WorkerVNInfoAllocators;
+
     /// Live interval pointers for all the virtual registers.
     IndexedMap<LiveInterval*, VirtReg2IndexFunctor> VirtRegIntervals;
 
@@ -155,16 +160,23 @@ namespace llvm {
     bool shrinkToUses(LiveInterval *li,
                       SmallVectorImpl<MachineInstr*> *dead = nullptr);
 
+    /// Dead defs found by computeDeadValues, with their register.
+    typedef SmallVectorImpl<std::pair<MachineInstr*, unsigned> > DeadDefVector;
+
     /// \brief Walk the values in the given interval and compute which ones
     /// are dead.  Dead values are not deleted, however:
     /// - Dead PHIDef values are marked as unused.
     /// - New dead machine instructions are added to the dead vector.
     /// - CanSeparate is set to true if the interval may have been separated
     ///   into multiple connected components.
+    /// - If DeadDefs is given, dead defs are added to it with their register
+    ///   instead of being flagged on the instruction.  The caller must flag
+    ///   them, and dead must be null.
     void computeDeadValues(LiveInterval *li,
                            LiveRange &LR,
                            bool *CanSeparate,
-                           SmallVectorImpl<MachineInstr*> *dead);
+                           SmallVectorImpl<MachineInstr*> *dead,
+                           DeadDefVector *DeadDefs = nullptr);
 
     /// extendToIndices - Extend the live range of LI to reach all points in
     /// Indices. The points in the Indices array must be jointly dominated by
@@ -402,6 +414,10 @@ namespace llvm {
     /// Compute live intervals for all virtual registers.
     void computeVirtRegs();
 
+    /// Compute live intervals for all virtual registers on \p NumThreads
+    /// threads.
+    void computeVirtRegsInParallel(unsigned NumThreads);
+
     /// Compute RegMaskSlots and RegMaskBits.
     void computeRegMasks();
 
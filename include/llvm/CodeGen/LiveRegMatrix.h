@@ -25,6 +25,7 @@
 #define LLVM_CODEGEN_LIVEREGMATRIX_H
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/LiveIntervalUnion.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 
@@ -57,6 +58,36 @@ class LiveRegMatrix : public MachineFunctionPass {
   unsigned RegMaskVirtReg;
   BitVector RegMaskUsable;
 
+  // Per register unit, the number of assigned live segments overlapping each
+  // basic block, indexed by block number. A virtual register can only
+  // interfere with a register unit in blocks where both are live, so most
+  // interference checks are answered without searching the unit's
+  // LiveIntervalUnion. A unit's vector is allocated on first assignment.
+  std::vector<std::vector<unsigned> > UnitBlockUse;
+  unsigned NumBlocks;
+
+  // Cached blocks overlapped by the virtual register being checked.
+  unsigned LiveBlocksTag;
+  unsigned LiveBlocksVirtReg;
+  unsigned LiveBlocksSize;
+  SlotIndex LiveBlocksStart, LiveBlocksEnd;
+  SmallVector<unsigned, 16> LiveBlocks;
+
+  // Collect the numbers of the blocks overlapped by VirtReg in layout order.
+  void collectLiveBlocks(const LiveInterval &VirtReg,
+                         SmallVectorImpl<unsigned> &Blocks) const;
+
+  // Return the cached result of collectLiveBlocks for VirtReg.
+  const SmallVectorImpl<unsigned> &getLiveBlocks(const LiveInterval &VirtReg);
+
+  // Add Delta to the block use counts of the units in PhysReg.
+  void updateBlockUse(const SmallVectorImpl<unsigned> &Blocks,
+                      unsigned PhysReg, int Delta);
+
+  // Return true if something is assigned to RegUnit in one of Blocks.
+  bool isUnitUsedInBlocks(unsigned RegUnit,
+                          const SmallVectorImpl<unsigned> &Blocks) const;
+
   // MachineFunctionPass boilerplate.
   void getAnalysisUsage(AnalysisUsage&) const override;
   bool runOnMachineFunction(MachineFunction&) override;
@@ -477,6 +477,29 @@ public:
     llvm_unreachable("No support for ProcessAllSections option");
   }
 
+  /// setLazyFunctionCompilation (MCJIT Only): By default MCJIT compiles a whole
+  /// module the first time any symbol in it is needed. Passing 'true' to this
+  /// method splits the functions of every module added to the engine into
+  /// modules of their own, so that only the functions which are actually
+  /// referenced get compiled.
+  ///
+  /// Once enabled, clients must find functions through the engine rather
+  /// than by walking their modules, since function bodies are moved out of
+  /// the modules the client added.  Passing 'false' stops background
+  /// compilation; functions already split out stay in their own modules.
+  virtual void setLazyFunctionCompilation(bool Enabled) {}
+
+  /// precompileFunction (MCJIT Only): Hint that the function named like F is
+  /// likely to be needed soon. When lazy function compilation is enabled the
+  /// engine compiles it ahead of time on a background thread, picking the
+  /// queued function with the highest Hotness first. The code still has to be
+  /// looked up through getFunctionAddress or getPointerToFunction before use.
+  ///
+  /// The background thread holds the engine's lock while it compiles.
+  /// Clients that create IR in the context of the engine's modules while
+  /// functions are queued must hold it too.
+  virtual void precompileFunction(Function *F, unsigned Hotness = 0) {}
+
   /// Return the target machine (if available).
   virtual TargetMachine *getTargetMachine() { return nullptr; }
 
@@ -0,0 +1,87 @@
+//===-- FileObjectCache.h - Persistent on-disk ObjectCache ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares FileObjectCache, an ObjectCache that keeps compiled
+// objects in a directory on disk so that they can be reused across runs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_FILEOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/Compiler.h"
+#include <string>
+
+namespace llvm {
+
+class TargetMachine;
+
+/// FileObjectCache - An ObjectCache which stores objects in a directory.
+///
+/// Each object is named after a hash of the module's bitcode together with
+/// the target triple, CPU, feature string and code generation options of the
+/// TargetMachine it was compiled for, so a cached object is only reused when
+/// the same code would have been generated again.  Objects are written to a
+/// temporary file and renamed into place, which makes it safe for several
+/// processes to share one cache directory.
+///
+/// If a size limit is given, the least recently used objects are removed
+/// when the cache is created and whenever a new object pushes the directory
+/// over the limit.  Cache hits refresh the modification time of the object
+/// they load.
+///
+/// The owning ExecutionEngine serializes calls into the cache, and
+/// getObject() must be called for a module before notifyObjectCompiled(),
+/// as MCJIT does: the key is computed before code generation, which is
+/// allowed to modify the module.
+class FileObjectCache : public ObjectCache {
+  FileObjectCache(const FileObjectCache &) LLVM_DELETED_FUNCTION;
+  void operator=(const FileObjectCache &) LLVM_DELETED_FUNCTION;
+
+public:
+  /// Create a cache in \p CacheDir for objects generated by \p TM.  The
+  /// directory is created on the first write.  A \p MaxCacheSize of zero
+  /// means the cache is never pruned.
+  FileObjectCache(StringRef CacheDir, const TargetMachine &TM,
+                  uint64_t MaxCacheSize = 0);
+  ~FileObjectCache();
+
+  void notifyObjectCompiled(const Module *M, const MemoryBuffer *Obj) override;
+  MemoryBuffer *getObject(const Module *M) override;
+
+  /// getCacheKey - Return the hex string identifying the object that \p M
+  /// compiles to.
+  std::string getCacheKey(const Module *M) const;
+
+  StringRef getCacheDir() const { return CacheDir; }
+  uint64_t getMaxCacheSize() const { return MaxCacheSize; }
+
+  /// pruneCache - Remove least recently used objects until the cache fits in
+  /// its size limit.  Called automatically on construction and after each
+  /// new object is stored.
+  void pruneCache();
+
+private:
+  void getObjectPath(StringRef Key, SmallVectorImpl<char> &Path) const;
+
+  std::string CacheDir;
+  const TargetMachine &TM;
+  uint64_t MaxCacheSize;
+
+  /// Keys computed by getObject() for modules which missed in the cache and
+  /// are about to be compiled.
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace llvm
+
+#endif
@@ -34,12 +34,24 @@ namespace llvm {
 /// in the JITed object.  Permissions can be applied either by calling
 /// MCJIT::finalizeObject or by calling SectionMemoryManager::finalizeMemory
 /// directly.  Clients of MCJIT should call MCJIT::finalizeObject.
+///
+/// Code, read-only data and read-write data are carved out of separate slabs.
+/// Finalizing only changes the permissions of the pages handed out since the
+/// previous finalization, and the rest of each slab stays writable for later
+/// objects, so many small objects can share a few mappings without any page
+/// ever being writable and executable at the same time.
 class SectionMemoryManager : public RTDyldMemoryManager {
   SectionMemoryManager(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
   void operator=(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
 
 public:
-  SectionMemoryManager() { }
+  /// Create a memory manager which maps memory in slabs of at least
+  /// \p SlabSize bytes; zero maps only as much as each request needs.  If
+  /// \p UseHugePages is set, code slabs are rounded up to 2 MB and the system
+  /// is asked to back them with huge pages to reduce iTLB misses.
+  explicit SectionMemoryManager(uintptr_t SlabSize = 0,
+                                bool UseHugePages = false)
+    : SlabSize(SlabSize), UseHugePages(UseHugePages) { }
   virtual ~SectionMemoryManager();
 
   /// \brief Allocates a memory block of (at least) the given size suitable for
@@ -79,13 +91,16 @@ public:
   /// explicit cache flush, otherwise JIT code manipulations (like resolved
   /// relocations) will get to the data cache but not to the instruction cache.
   ///
-  /// This method is called from finalizeMemory.
+  /// This method is called from finalizeMemory, and covers the code pages
+  /// that call is finalizing.
   virtual void invalidateInstructionCache();
 
 private:
   struct MemoryGroup {
       SmallVector<sys::MemoryBlock, 16> AllocatedMem;
       SmallVector<sys::MemoryBlock, 16> FreeMem;
+      /// Memory handed out since the last call to finalizeMemory.
+      SmallVector<sys::MemoryBlock, 16> PendingMem;
       sys::MemoryBlock Near;
   };
 
@@ -95,6 +110,8 @@ private:
   std::error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                               unsigned Permissions);
 
+  uintptr_t SlabSize;
+  bool UseHugePages;
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
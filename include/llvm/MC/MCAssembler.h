@@ -952,13 +952,27 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
+  /// The fragments of a section which may still change size during
+  /// relaxation, see layoutSectionOnce().
+  struct RelaxationWorklist;
+
   /// \brief Perform one layout iteration and return true if any offsets
   /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  bool layoutOnce(MCAsmLayout &Layout,
+                  std::vector<RelaxationWorklist> &Worklists);
 
   /// \brief Perform one layout iteration of the given section and return true
   /// if any offsets were adjusted.
-  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD);
+  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                         RelaxationWorklist &Worklist);
+
+  /// \brief Collect the fragments of \p SD which may change size, and the
+  /// range of fragments each of them depends on.
+  void initRelaxationWorklist(MCSectionData &SD,
+                              RelaxationWorklist &Worklist) const;
+
+  /// \brief Relax a single fragment and return true if its size changed.
+  bool relaxFragment(MCAsmLayout &Layout, MCFragment &F);
 
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
@@ -14,12 +14,14 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <memory>
 
 namespace llvm {
 namespace object {
@@ -189,6 +191,10 @@ public:
   }
 
   // check if a symbol is in the archive
+  //
+  // The first lookup indexes the whole symbol table, so later lookups take
+  // constant time.  Like the rest of Archive, this is not safe to call from
+  // several threads at once.
   child_iterator findSym(StringRef name) const;
 
   bool hasSymbolTable() const;
@@ -198,6 +204,10 @@ private:
   child_iterator StringTable;
   child_iterator FirstRegular;
   Kind Format;
+
+  /// Maps each symbol name to the index of its first entry in the symbol
+  /// table.  Built by the first findSym().
+  mutable std::unique_ptr<StringMap<uint32_t> > SymbolIndex;
 };
 
 }
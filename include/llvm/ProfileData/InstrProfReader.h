@@ -17,7 +17,9 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/LineIterator.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/EndianStream.h"
@@ -208,8 +210,14 @@ enum class HashT : uint32_t;
 class InstrProfLookupTrait {
   std::vector<uint64_t> CountBuffer;
   IndexedInstrProf::HashT HashType;
+  /// The version of the indexed format being read.
+  uint64_t FormatVersion;
+  /// The start of the profile data, which records are aligned relative to.
+  const unsigned char *Base;
 public:
-  InstrProfLookupTrait(IndexedInstrProf::HashT HashType) : HashType(HashType) {}
+  InstrProfLookupTrait(IndexedInstrProf::HashT HashType, uint64_t FormatVersion,
+                       const unsigned char *Base)
+      : HashType(HashType), FormatVersion(FormatVersion), Base(Base) {}
 
   typedef InstrProfRecord data_type;
   typedef StringRef internal_key_type;
@@ -234,26 +242,10 @@ public:
     return StringRef((const char *)D, N);
   }
 
-  InstrProfRecord ReadData(StringRef K, const unsigned char *D, offset_type N) {
-    if (N < 2 * sizeof(uint64_t) || N % sizeof(uint64_t)) {
-      // The data is corrupt, don't try to read it.
-      CountBuffer.clear();
-      return InstrProfRecord("", 0, CountBuffer);
-    }
-
-    using namespace support;
-
-    // The first stored value is the hash.
-    uint64_t Hash = endian::readNext<uint64_t, little, unaligned>(D);
-    // Each counter follows.
-    unsigned NumCounters = N / sizeof(uint64_t) - 1;
-    CountBuffer.clear();
-    CountBuffer.reserve(NumCounters - 1);
-    for (unsigned I = 0; I < NumCounters; ++I)
-      CountBuffer.push_back(endian::readNext<uint64_t, little, unaligned>(D));
-
-    return InstrProfRecord(K, Hash, CountBuffer);
-  }
+  /// Read the record at D. When the counters can be used in place the record
+  /// refers directly to the profile data, otherwise it refers to a buffer
+  /// that is reused by the next call.
+  InstrProfRecord ReadData(StringRef K, const unsigned char *D, offset_type N);
 };
 typedef OnDiskIterableChainedHashTable<InstrProfLookupTrait>
     InstrProfReaderIndex;
@@ -270,6 +262,12 @@ private:
   /// The maximal execution count among all fucntions.
   uint64_t MaxFunctionCount;
 
+  /// Counts that couldn't be referenced in place, by the record's name in
+  /// DataBuffer, so that each record is only copied once.
+  DenseMap<const char *, ArrayRef<uint64_t>> CopiedCounts;
+  /// Storage for counts that can't be referenced in place in DataBuffer.
+  BumpPtrAllocator CountsAllocator;
+
   IndexedInstrProfReader(const IndexedInstrProfReader &) LLVM_DELETED_FUNCTION;
   IndexedInstrProfReader &operator=(const IndexedInstrProfReader &)
     LLVM_DELETED_FUNCTION;
@@ -289,6 +287,10 @@ public:
   /// Fill Counts with the profile data for the given function name.
   std::error_code getFunctionCounts(StringRef FuncName, uint64_t &FuncHash,
                                     std::vector<uint64_t> &Counts);
+  /// Point Counts at the profile data for the given function name. The data
+  /// is not copied when possible and stays valid for the life of the reader.
+  std::error_code getFunctionCounts(StringRef FuncName, uint64_t &FuncHash,
+                                    ArrayRef<uint64_t> &Counts);
   /// Return the maximum of all known function counts.
   uint64_t getMaximumFunctionCount() { return MaxFunctionCount; }
 
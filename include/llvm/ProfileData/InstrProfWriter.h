@@ -16,6 +16,7 @@
 #define LLVM_PROFILEDATA_INSTRPROF_WRITER_H_
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Support/DataTypes.h"
@@ -41,6 +42,16 @@ public:
   std::error_code addFunctionCounts(StringRef FunctionName,
                                     uint64_t FunctionHash,
                                     ArrayRef<uint64_t> Counters);
+  /// Merge the counts of every function in \p Other into this writer, with
+  /// the same rules as addFunctionCounts. \p Other is left empty. Functions
+  /// that cannot be merged are reported through \p Warn and keep the counts
+  /// already in this writer.
+  void mergeRecordsFromWriter(
+      InstrProfWriter &Other,
+      function_ref<void(StringRef, std::error_code)> Warn);
+  /// Remove every function whose entry count is below \p MinFunctionCount.
+  /// Returns the number of functions removed.
+  size_t removeColdFunctions(uint64_t MinFunctionCount);
   /// Ensure that all data is written to disk.
   void write(raw_fd_ostream &OS);
 };
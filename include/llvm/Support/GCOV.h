@@ -15,6 +15,7 @@
 #ifndef LLVM_SUPPORT_GCOV_H
 #define LLVM_SUPPORT_GCOV_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
@@ -351,10 +352,13 @@ class FileInfo {
   // Therefore this typedef allows LineData.Functions to store multiple functions
   // per instance. This is rare, however, so optimize for the common case.
   typedef SmallVector<const GCOVFunction *, 1> FunctionVector;
-  typedef DenseMap<uint32_t, FunctionVector> FunctionLines;
+  typedef std::vector<FunctionVector> FunctionLines;
   typedef SmallVector<const GCOVBlock *, 4> BlockVector;
-  typedef DenseMap<uint32_t, BlockVector> BlockLines;
+  typedef std::vector<BlockVector> BlockLines;
 
+  // Both tables are indexed by line number minus one and grow to the highest
+  // line seen so far; most lines of a source file hold code, so this is
+  // denser and faster to build than a map.
   struct LineData {
     LineData() : LastLine(0) {}
     BlockLines Blocks;
@@ -377,23 +381,53 @@ class FileInfo {
     uint32_t BranchesTaken;
   };
 public:
-  FileInfo(const GCOVOptions &Options) :
-    Options(Options), LineInfo(), RunCount(0), ProgramCount(0) {}
+  /// CoverageReport - The path and contents of a .gcov file.
+  typedef std::pair<std::string, std::string> CoverageReport;
 
+  FileInfo(const GCOVOptions &Options) :
+    Options(Options), LineInfo(), RunCount(0), ProgramCount(0),
+    KeepReports(false) {}
+
+  void addBlockLines(StringRef Filename, ArrayRef<uint32_t> Lines,
+                     const GCOVBlock *Block) {
+    if (Lines.empty())
+      return;
+    LineData &Data = LineInfo[Filename];
+    for (uint32_t Line : Lines) {
+      if (Line > Data.LastLine)
+        Data.LastLine = Line;
+      if (Line > Data.Blocks.size())
+        Data.Blocks.resize(Line);
+      Data.Blocks[Line-1].push_back(Block);
+    }
+  }
   void addBlockLine(StringRef Filename, uint32_t Line, const GCOVBlock *Block) {
-    if (Line > LineInfo[Filename].LastLine)
-      LineInfo[Filename].LastLine = Line;
-    LineInfo[Filename].Blocks[Line-1].push_back(Block);
+    addBlockLines(Filename, Line, Block);
   }
   void addFunctionLine(StringRef Filename, uint32_t Line,
                        const GCOVFunction *Function) {
-    if (Line > LineInfo[Filename].LastLine)
-      LineInfo[Filename].LastLine = Line;
-    LineInfo[Filename].Functions[Line-1].push_back(Function);
+    LineData &Data = LineInfo[Filename];
+    if (Line > Data.LastLine)
+      Data.LastLine = Line;
+    if (Line > Data.Functions.size())
+      Data.Functions.resize(Line);
+    Data.Functions[Line-1].push_back(Function);
   }
   void setRunCount(uint32_t Runs) { RunCount = Runs; }
   void setProgramCount(uint32_t Programs) { ProgramCount = Programs; }
   void print(StringRef MainFilename, StringRef GCNOFile, StringRef GCDAFile);
+  /// print - Like print() above, but write the coverage summary to \p InfoOS
+  /// rather than to outs().
+  void print(raw_ostream &InfoOS, StringRef MainFilename, StringRef GCNOFile,
+             StringRef GCDAFile);
+
+  /// keepReports - Keep the .gcov files print() produces in memory instead of
+  /// writing them, so that a caller processing several coverage files at
+  /// once can write them out in a deterministic order.
+  void keepReports() { KeepReports = true; }
+  std::vector<CoverageReport> &getReports() { return Reports; }
+  /// writeReport - Write a report kept by print() to its .gcov file.
+  void writeReport(const CoverageReport &Report);
 
 private:
   std::string getCoveragePath(StringRef Filename, StringRef MainFilename);
@@ -407,14 +441,16 @@ private:
   void printUncondBranchInfo(raw_ostream &OS, uint32_t &EdgeNo,
                              uint64_t Count) const;
 
-  void printCoverage(const GCOVCoverage &Coverage) const;
-  void printFuncCoverage() const;
-  void printFileCoverage() const;
+  void printCoverage(raw_ostream &OS, const GCOVCoverage &Coverage) const;
+  void printFuncCoverage(raw_ostream &OS) const;
+  void printFileCoverage(raw_ostream &OS) const;
 
   const GCOVOptions &Options;
   StringMap<LineData> LineInfo;
   uint32_t RunCount;
   uint32_t ProgramCount;
+  bool KeepReports;
+  std::vector<CoverageReport> Reports;
 
   typedef SmallVector<std::pair<std::string, GCOVCoverage>, 4>
       FileCoverageList;
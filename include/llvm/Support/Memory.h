@@ -47,7 +47,11 @@ namespace sys {
     enum ProtectionFlags {
       MF_READ  = 0x1000000,
       MF_WRITE = 0x2000000,
-      MF_EXEC  = 0x4000000
+      MF_EXEC  = 0x4000000,
+      /// Not a protection flag: asks allocateMappedMemory to back the block
+      /// with huge pages where the system supports it.  Only useful for large,
+      /// long-lived blocks; ignored elsewhere.
+      MF_HUGE_PAGE_HINT = 0x8000000
     };
 
     /// This method allocates a block of memory that is suitable for loading
@@ -0,0 +1,98 @@
+//===-- llvm/Support/ThreadPool.h - A ThreadPool implementation -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a crude C++11 based thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADPOOL_H
+#define LLVM_SUPPORT_THREADPOOL_H
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#if LLVM_ENABLE_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace llvm {
+
+/// A ThreadPool for asynchronous parallel execution on a defined number of
+/// threads.
+///
+/// The pool keeps a vector of threads alive, waiting on a condition variable
+/// for some work to become available. Tasks are started in the order they
+/// were submitted. Constructing a pool puts LLVM in multithreaded mode (see
+/// llvm_start_multithreaded) if it is not already. When LLVM is built without
+/// thread support, tasks are run sequentially on the calling thread by wait().
+class ThreadPool {
+public:
+  typedef std::function<void()> TaskTy;
+
+  /// Construct a pool with the number of hardware threads available.
+  ThreadPool();
+
+  /// Construct a pool of \p ThreadCount threads. A count of zero means the
+  /// number of hardware threads available.
+  explicit ThreadPool(unsigned ThreadCount);
+
+  /// Blocking destructor: the pool waits for all the pending tasks to
+  /// complete.
+  ~ThreadPool();
+
+  /// Schedule \p Task for asynchronous execution.
+  void async(TaskTy Task);
+
+  /// Blocking wait for all the tasks scheduled so far to complete.
+  void wait();
+
+  /// Returns the number of threads a pool constructed with \p ThreadCount
+  /// would run.
+  static unsigned getThreadCount(unsigned ThreadCount = 0);
+
+private:
+  ThreadPool(const ThreadPool &) LLVM_DELETED_FUNCTION;
+  void operator=(const ThreadPool &) LLVM_DELETED_FUNCTION;
+
+  /// Tasks waiting for execution in the pool.
+  std::queue<TaskTy> Tasks;
+
+#if LLVM_ENABLE_THREADS
+  void startThreads(unsigned ThreadCount);
+  void workerLoop();
+
+  /// Threads in flight.
+  std::vector<std::thread> Threads;
+
+  /// Lock protecting Tasks, ActiveThreads and EnableFlag.
+  std::mutex QueueLock;
+
+  /// Signaled when a task is queued or the pool is being destroyed.
+  std::condition_variable QueueCondition;
+
+  /// Signaled when a task completes.
+  std::condition_variable CompletionCondition;
+
+  /// Number of tasks currently being executed.
+  unsigned ActiveThreads;
+
+  /// Signal for the destruction of the pool, asking threads to exit.
+  bool EnableFlag;
+#endif
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_THREADPOOL_H
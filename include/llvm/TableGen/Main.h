@@ -17,12 +17,23 @@
 namespace llvm {
 
 class RecordKeeper;
+class StringRef;
 class raw_ostream;
 /// \brief Perform the action using Records, and write output to OS.
 /// \returns true on error, false otherwise
 typedef bool TableGenMainFn(raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// \brief Perform the action named Action (an action option without its
+/// leading dash, e.g. "gen-instr-info") using Records, and write output to OS.
+/// \returns true on error, including an unknown action, false otherwise
+typedef bool TableGenActionFn(raw_ostream &OS, RecordKeeper &Records,
+                              StringRef Action);
+
+/// \brief Parse the input file and run MainFn on it.  If ActionFn is given,
+/// each -write-output=<action>=<file> option also runs ActionFn over the
+/// same records, so that several outputs are produced from a single parse.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 TableGenActionFn *ActionFn = nullptr);
 }
 
 #endif
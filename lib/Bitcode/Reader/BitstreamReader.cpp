@@ -75,8 +75,9 @@ bool BitstreamCursor::EnterSubBlock(unsigned BlockID, unsigned *NumWordsP) {
   unsigned NumWords = Read(bitc::BlockSizeWidth);
   if (NumWordsP) *NumWordsP = NumWords;
 
-  // Validate that this block is sane.
-  if (CurCodeSize == 0 || AtEndOfStream())
+  // Validate that this block is sane.  Abbrev IDs are read with Read(), which
+  // cannot return more than 32 bits.
+  if (CurCodeSize == 0 || CurCodeSize > 32 || AtEndOfStream())
     return true;
 
   return false;
@@ -132,6 +133,99 @@ void BitstreamCursor::skipAbbreviatedField(const BitCodeAbbrevOp &Op) {
 
 
 
+/// getFastFieldWidth - If elements in the given encoding can be decoded by
+/// the specialized array loops, return the fewest bits each one occupies.
+/// Otherwise return zero, and the elements are read one at a time.
+static unsigned getFastFieldWidth(const BitCodeAbbrevOp &Op) {
+  if (Op.isLiteral())
+    return 0;
+
+  switch (Op.getEncoding()) {
+  case BitCodeAbbrevOp::Fixed:
+  case BitCodeAbbrevOp::VBR:
+    if (Op.getEncodingData() > 32)
+      return 0;
+    return (unsigned)Op.getEncodingData();
+  case BitCodeAbbrevOp::Char6:
+    return 6;
+  default:
+    return 0;
+  }
+}
+
+/// canReadFields - Return true if the stream holds at least NumElts fields of
+/// MinWidth bits past the current position, so that storage for them can be
+/// allocated up front without trusting a corrupt element count.
+bool BitstreamCursor::canReadFields(uint64_t NumElts, unsigned MinWidth) {
+  uint64_t EndBit = GetCurrentBitNo() + NumElts*MinWidth;
+  return canSkipToPos(EndBit/8);
+}
+
+/// readVBR6Array - Read NumElts vbr6 values, as used by unabbreviated records,
+/// into Vals.
+void BitstreamCursor::readVBR6Array(unsigned NumElts,
+                                    SmallVectorImpl<uint64_t> &Vals) {
+  if (!canReadFields(NumElts, 6)) {
+    for (; NumElts; --NumElts)
+      Vals.push_back(ReadVBR64(6));
+    return;
+  }
+
+  size_t Start = Vals.size();
+  Vals.resize(Start + NumElts);
+  uint64_t *Out = Vals.data() + Start;
+  for (unsigned i = 0; i != NumElts; ++i)
+    Out[i] = ReadVBR64(6);
+}
+
+/// readArray - Read NumElts values in the element encoding of an array operand
+/// into Vals.  The encoding is dispatched once for the whole array rather than
+/// once per element.
+void BitstreamCursor::readArray(const BitCodeAbbrevOp &EltEnc,
+                                unsigned NumElts,
+                                SmallVectorImpl<uint64_t> &Vals) {
+  // Malformed element encodings, and counts larger than the rest of the
+  // stream could hold, are read one element at a time; elements past the end
+  // of the stream read as zero.
+  unsigned MinWidth = getFastFieldWidth(EltEnc);
+  if (!MinWidth || !canReadFields(NumElts, MinWidth)) {
+    for (; NumElts; --NumElts)
+      readAbbreviatedField(EltEnc, Vals);
+    return;
+  }
+
+  size_t Start = Vals.size();
+  Vals.resize(Start + NumElts);
+  uint64_t *Out = Vals.data() + Start;
+  if (EltEnc.getEncoding() == BitCodeAbbrevOp::Fixed) {
+    for (unsigned i = 0; i != NumElts; ++i)
+      Out[i] = Read(MinWidth);
+  } else if (EltEnc.getEncoding() == BitCodeAbbrevOp::VBR) {
+    for (unsigned i = 0; i != NumElts; ++i)
+      Out[i] = ReadVBR64(MinWidth);
+  } else {
+    for (unsigned i = 0; i != NumElts; ++i)
+      Out[i] = BitCodeAbbrevOp::DecodeChar6(Read(6));
+  }
+}
+
+/// skipArray - Skip over NumElts values in the element encoding of an array
+/// operand.  Fixed width elements are jumped over without being read.
+void BitstreamCursor::skipArray(const BitCodeAbbrevOp &EltEnc,
+                                unsigned NumElts) {
+  unsigned MinWidth = getFastFieldWidth(EltEnc);
+  if (MinWidth && EltEnc.getEncoding() != BitCodeAbbrevOp::VBR) {
+    uint64_t EndBit = GetCurrentBitNo() + uint64_t(NumElts)*MinWidth;
+    if (canSkipToPos(EndBit/8)) {
+      JumpToBit(EndBit);
+      return;
+    }
+  }
+
+  for (; NumElts; --NumElts)
+    skipAbbreviatedField(EltEnc);
+}
+
 /// skipRecord - Read the current record and discard it.
 void BitstreamCursor::skipRecord(unsigned AbbrevID) {
   // Skip unabbreviated records by reading past their entries.
@@ -165,9 +259,8 @@ void BitstreamCursor::skipRecord(unsigned AbbrevID) {
       assert(i+2 == e && "array op not second to last?");
       const BitCodeAbbrevOp &EltEnc = Abbv->getOperandInfo(++i);
 
-      // Read all the elements.
-      for (; NumElts; --NumElts)
-        skipAbbreviatedField(EltEnc);
+      // Skip all the elements.
+      skipArray(EltEnc, NumElts);
       continue;
     }
 
@@ -197,8 +290,7 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
   if (AbbrevID == bitc::UNABBREV_RECORD) {
     unsigned Code = ReadVBR(6);
     unsigned NumElts = ReadVBR(6);
-    for (unsigned i = 0; i != NumElts; ++i)
-      Vals.push_back(ReadVBR64(6));
+    readVBR6Array(NumElts, Vals);
     return Code;
   }
 
@@ -235,8 +327,7 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
       const BitCodeAbbrevOp &EltEnc = Abbv->getOperandInfo(++i);
 
       // Read all the elements.
-      for (; NumElts; --NumElts)
-        readAbbreviatedField(EltEnc, Vals);
+      readArray(EltEnc, NumElts, Vals);
       continue;
     }
 
@@ -266,8 +357,8 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
       *Blob = StringRef(Ptr, NumElts);
     } else {
       // Otherwise, unpack into Vals with zero extension.
-      for (; NumElts; --NumElts)
-        Vals.push_back((unsigned char)*Ptr++);
+      const unsigned char *UPtr = (const unsigned char*)Ptr;
+      Vals.append(UPtr, UPtr + NumElts);
     }
     // Skip over tail padding.
     JumpToBit(NewEnd);
@@ -27,7 +27,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cctype>
 #include <map>
 using namespace llvm;
@@ -38,6 +40,11 @@ EnablePreserveUseListOrdering("enable-bc-uselist-preserve",
                                        "use-list order preservation."),
                               cl::init(false), cl::Hidden);
 
+static cl::opt<unsigned>
+BitcodeWriterThreads("bitcode-writer-threads", cl::Hidden, cl::init(1),
+                     cl::desc("Number of threads encoding function blocks "
+                              "(0 uses all hardware threads)"));
+
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
 enum {
@@ -1890,6 +1897,75 @@ static void WriteModuleUseLists(const Module *M, ValueEnumerator &VE,
   Stream.ExitBlock();
 }
 
+namespace {
+/// Function blocks encoded by one thread, and the offset in Buffer at which
+/// each of them ends.  The first one starts at Begin.
+struct EncodedFunctionBlocks {
+  SmallVector<char, 0> Buffer;
+  size_t Begin;
+  std::vector<size_t> Ends;
+};
+}
+
+/// WriteFunctionsInParallel - Emit the function bodies of the module, encoding
+/// them on several threads.  Once the module-level values are enumerated each
+/// function block only depends on the function itself, so every thread
+/// incorporates functions into its own copy of the enumerator and writes
+/// their blocks to its own stream.  The blocks are then appended to the
+/// module stream in order, giving the same bits as WriteFunction would.
+static void WriteFunctionsInParallel(const Module *M, const ValueEnumerator &VE,
+                                     BitstreamWriter &Stream,
+                                     unsigned NumThreads) {
+  std::vector<const Function *> Functions;
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Functions.push_back(F);
+  NumThreads = std::min<size_t>(NumThreads, Functions.size());
+  if (NumThreads == 0)
+    return;
+
+  // Encode a window of functions at a time to bound the memory held by the
+  // per-thread streams.
+  std::vector<std::unique_ptr<ValueEnumerator>> Enumerators(NumThreads);
+  ThreadPool Pool(NumThreads);
+  size_t Window = NumThreads * 64;
+  for (size_t WBegin = 0, WEnd; WBegin < Functions.size(); WBegin = WEnd) {
+    WEnd = std::min(Functions.size(), WBegin + Window);
+    std::vector<EncodedFunctionBlocks> Chunks(NumThreads);
+    for (unsigned T = 0; T != NumThreads; ++T) {
+      size_t Begin = WBegin + (WEnd - WBegin) * T / NumThreads;
+      size_t End = WBegin + (WEnd - WBegin) * (T + 1) / NumThreads;
+      EncodedFunctionBlocks *Chunk = &Chunks[T];
+      std::unique_ptr<ValueEnumerator> *ThreadVE = &Enumerators[T];
+      Pool.async([&Functions, &VE, Begin, End, Chunk, ThreadVE] {
+        if (!*ThreadVE)
+          ThreadVE->reset(new ValueEnumerator(VE));
+
+        // Set up the same blockinfo abbreviations and code size as the module
+        // stream has where the function blocks go.
+        BitstreamWriter ThreadStream(Chunk->Buffer);
+        WriteBlockInfo(**ThreadVE, ThreadStream);
+        ThreadStream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
+        Chunk->Begin = Chunk->Buffer.size();
+        for (size_t I = Begin; I != End; ++I) {
+          WriteFunction(*Functions[I], **ThreadVE, ThreadStream);
+          Chunk->Ends.push_back(Chunk->Buffer.size());
+        }
+        ThreadStream.ExitBlock();
+      });
+    }
+    Pool.wait();
+
+    for (const EncodedFunctionBlocks &Chunk : Chunks) {
+      size_t Begin = Chunk.Begin;
+      for (size_t End : Chunk.Ends) {
+        Stream.EmitBlocks(StringRef(Chunk.Buffer.data() + Begin, End - Begin));
+        Begin = End;
+      }
+    }
+  }
+}
+
 /// WriteModule - Emit the specified module to the bitstream.
 static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
@@ -1934,10 +2010,17 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   if (EnablePreserveUseListOrdering)
     WriteModuleUseLists(M, VE, Stream);
 
-  // Emit function bodies.
-  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
-    if (!F->isDeclaration())
-      WriteFunction(*F, VE, Stream);
+  // Emit function bodies.  Blocks encoded on other threads can only be
+  // spliced in at a 32-bit boundary, where the preceding block normally
+  // leaves the stream.
+  unsigned NumThreads = ThreadPool::getThreadCount(BitcodeWriterThreads);
+  if (NumThreads > 1 && Stream.GetCurrentBitNo() % 32 == 0) {
+    WriteFunctionsInParallel(M, VE, Stream, NumThreads);
+  } else {
+    for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+      if (!F->isDeclaration())
+        WriteFunction(*F, VE, Stream);
+  }
 
   Stream.ExitBlock();
 }
@@ -114,6 +114,19 @@ ValueEnumerator::ValueEnumerator(const Module *M) {
   OptimizeConstants(FirstConstant, Values.size());
 }
 
+ValueEnumerator::ValueEnumerator(const ValueEnumerator &VE)
+    : TypeMap(VE.TypeMap), Types(VE.Types), ValueMap(VE.ValueMap),
+      Values(VE.Values), MDValues(VE.MDValues), MDValueMap(VE.MDValueMap),
+      AttributeGroupMap(VE.AttributeGroupMap),
+      AttributeGroups(VE.AttributeGroups), AttributeMap(VE.AttributeMap),
+      Attribute(VE.Attribute), InstructionCount(0),
+      NumModuleValues(VE.Values.size()),
+      NumModuleMDValues(VE.MDValues.size()), FirstFuncConstantID(0),
+      FirstInstID(0) {
+  assert(VE.BasicBlocks.empty() && VE.FunctionLocalMDs.empty() &&
+         "Cannot copy an enumerator with a function incorporated!");
+}
+
 unsigned ValueEnumerator::getInstructionID(const Instruction *Inst) const {
   InstructionMapType::const_iterator I = InstructionMap.find(Inst);
   assert(I != InstructionMap.end() && "Instruction is not mapped!");
@@ -415,13 +428,16 @@ void ValueEnumerator::EnumerateOperandType(const Value *V) {
 void ValueEnumerator::EnumerateAttributes(AttributeSet PAL) {
   if (PAL.isEmpty()) return;  // null is always 0.
 
-  // Do a lookup.
+  // Do a lookup.  The attribute groups of a list seen before have already
+  // been enumerated; returning early also avoids looking them up in the
+  // context, which function-level enumeration may do on several threads.
   unsigned &Entry = AttributeMap[PAL];
-  if (Entry == 0) {
-    // Never saw this before, add it.
-    Attribute.push_back(PAL);
-    Entry = Attribute.size();
-  }
+  if (Entry != 0)
+    return;
+
+  // Never saw this before, add it.
+  Attribute.push_back(PAL);
+  Entry = Attribute.size();
 
   // Do lookups for all attribute groups.
   for (unsigned i = 0, e = PAL.getNumSlots(); i != e; ++i) {
@@ -83,11 +83,15 @@ private:
   unsigned FirstFuncConstantID;
   unsigned FirstInstID;
 
-  ValueEnumerator(const ValueEnumerator &) LLVM_DELETED_FUNCTION;
   void operator=(const ValueEnumerator &) LLVM_DELETED_FUNCTION;
 public:
   ValueEnumerator(const Module *M);
 
+  /// Copy the module-level enumeration of \p VE, which must not have a
+  /// function incorporated.  The copy can incorporate functions independently
+  /// of \p VE, for example on another thread.
+  explicit ValueEnumerator(const ValueEnumerator &VE);
+
   void dump() const;
   void print(raw_ostream &OS, const ValueMapType &Map, const char *Name) const;
 
@@ -32,6 +32,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetMachine.h"
@@ -62,6 +63,16 @@ static cl::opt<bool> EnablePrecomputePhysRegs(
 static bool EnablePrecomputePhysRegs = false;
 #endif // NDEBUG
 
+static cl::opt<unsigned> LiveIntervalThreads(
+  "live-interval-threads", cl::Hidden, cl::init(1),
+  cl::desc("Number of threads computing virtual register live intervals "
+           "(0 uses all hardware threads)"));
+
+static cl::opt<unsigned> ParallelLiveIntervalThreshold(
+  "parallel-live-interval-threshold", cl::Hidden, cl::init(4096),
+  cl::desc("Minimum number of virtual registers before their live "
+           "intervals are computed on multiple threads"));
+
 void LiveIntervals::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesCFG();
   AU.addRequired<AliasAnalysis>();
@@ -103,6 +114,7 @@ void LiveIntervals::releaseMemory() {
 
   // Release VNInfo memory regions, VNInfo objects don't need to be dtor'd.
   VNInfoAllocator.Reset();
+  DeleteContainerPointers(WorkerVNInfoAllocators);
 }
 
 /// runOnMachineFunction - calculates LiveIntervals
@@ -190,6 +202,18 @@ void LiveIntervals::computeVirtRegInterval(LiveInterval &LI) {
 }
 
 void LiveIntervals::computeVirtRegs() {
+  unsigned NumThreads = ThreadPool::getThreadCount(LiveIntervalThreads);
+  bool Parallel = NumThreads > 1 &&
+                  MRI->getNumVirtRegs() >= ParallelLiveIntervalThreshold;
+#ifndef NDEBUG
+  // Keep the debug output readable.
+  Parallel = Parallel && !DebugFlag;
+#endif
+  if (Parallel) {
+    computeVirtRegsInParallel(NumThreads);
+    return;
+  }
+
   for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
     unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
     if (MRI->reg_nodbg_empty(Reg))
@@ -198,6 +222,74 @@ void LiveIntervals::computeVirtRegs() {
   }
 }
 
+namespace {
+/// A range of virtual registers computed by one task, together with the
+/// task's private VNInfo allocator and the dead defs it found.
+struct VirtRegWorkChunk {
+  unsigned Begin, End;
+  VNInfo::Allocator *Alloc;
+  SmallVector<std::pair<MachineInstr*, unsigned>, 16> DeadDefs;
+};
+}
+
+void LiveIntervals::computeVirtRegsInParallel(unsigned NumThreads) {
+  // The intervals are created up front so that the workers only fill them
+  // in.  Computing an interval reads the use-def lists, SlotIndexes and the
+  // dominator tree, and writes nothing but the interval and the kill flags of
+  // its own register's operands, so different registers can be computed
+  // concurrently.
+  std::vector<LiveInterval*> Work;
+  for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
+    if (MRI->reg_nodbg_empty(Reg))
+      continue;
+    Work.push_back(&createEmptyInterval(Reg));
+  }
+  if (Work.empty())
+    return;
+
+  // Use a few chunks per thread so that an expensive range of registers does
+  // not hold up the others.
+  unsigned NumChunks = std::min<unsigned>(Work.size(), NumThreads * 4);
+  std::vector<VirtRegWorkChunk> Chunks(NumChunks);
+  for (unsigned c = 0; c != NumChunks; ++c) {
+    Chunks[c].Begin = uint64_t(Work.size()) * c / NumChunks;
+    Chunks[c].End = uint64_t(Work.size()) * (c + 1) / NumChunks;
+    Chunks[c].Alloc = new VNInfo::Allocator();
+    WorkerVNInfoAllocators.push_back(Chunks[c].Alloc);
+  }
+
+  // dominates() renumbers the tree after enough queries while its DFS
+  // numbers are out of date.  Number it now so that the workers only read it.
+  DomTree->getBase().updateDFSNumbers();
+
+  {
+    ThreadPool Pool(NumThreads);
+    for (unsigned c = 0; c != NumChunks; ++c) {
+      VirtRegWorkChunk &Chunk = Chunks[c];
+      Pool.async([this, &Work, &Chunk] {
+        LiveRangeCalc Calc;
+        for (unsigned i = Chunk.Begin; i != Chunk.End; ++i) {
+          LiveInterval &LI = *Work[i];
+          Calc.reset(MF, Indexes, DomTree, Chunk.Alloc);
+          Calc.createDeadDefs(LI);
+          Calc.extendToUses(LI);
+          // Flagging dead defs changes instructions that other workers may
+          // be reading, so only record them here.
+          computeDeadValues(&LI, LI, nullptr, nullptr, &Chunk.DeadDefs);
+        }
+      });
+    }
+    Pool.wait();
+  }
+
+  // Flag the dead defs in register order, as the serial computation would.
+  for (unsigned c = 0; c != NumChunks; ++c)
+    for (unsigned i = 0, e = Chunks[c].DeadDefs.size(); i != e; ++i)
+      Chunks[c].DeadDefs[i].first->addRegisterDead(Chunks[c].DeadDefs[i].second,
+                                                  TRI);
+}
+
 void LiveIntervals::computeRegMasks() {
   RegMaskBlocks.resize(MF->getNumBlockIDs());
 
@@ -424,7 +516,9 @@ bool LiveIntervals::shrinkToUses(LiveInterval *li,
 void LiveIntervals::computeDeadValues(LiveInterval *li,
                                       LiveRange &LR,
                                       bool *CanSeparate,
-                                      SmallVectorImpl<MachineInstr*> *dead) {
+                                      SmallVectorImpl<MachineInstr*> *dead,
+                                      DeadDefVector *DeadDefs) {
+  assert(!(dead && DeadDefs) && "Dead instructions need flagged dead defs");
   for (LiveInterval::vni_iterator I = li->vni_begin(), E = li->vni_end();
        I != E; ++I) {
     VNInfo *VNI = *I;
@@ -442,9 +536,14 @@ void LiveIntervals::computeDeadValues(LiveInterval *li,
       if (CanSeparate)
         *CanSeparate = true;
     } else {
-      // This is a dead def. Make sure the instruction knows.
+      // This is a dead def. Make sure the instruction knows, or leave that
+      // to the caller.
       MachineInstr *MI = getInstructionFromIndex(VNI->def);
       assert(MI && "No instruction defining live value");
+      if (DeadDefs) {
+        DeadDefs->push_back(std::make_pair(MI, li->reg));
+        continue;
+      }
       MI->addRegisterDead(li->reg, TRI);
       if (dead && MI->allDefsAreDead()) {
         DEBUG(dbgs() << "All defs dead: " << VNI->def << '\t' << *MI);
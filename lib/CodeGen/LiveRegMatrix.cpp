@@ -17,6 +17,7 @@
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/VirtRegMap.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -28,6 +29,13 @@ using namespace llvm;
 
 STATISTIC(NumAssigned   , "Number of registers assigned");
 STATISTIC(NumUnassigned , "Number of registers unassigned");
+STATISTIC(NumBlockFiltered, "Number of interference queries skipped by the "
+                            "block filter");
+
+static cl::opt<bool>
+DisableBlockFilter("disable-liveregmatrix-block-filter", cl::Hidden,
+                   cl::desc("Always search the LiveIntervalUnions when "
+                            "checking for virtual register interference"));
 
 char LiveRegMatrix::ID = 0;
 INITIALIZE_PASS_BEGIN(LiveRegMatrix, "liveregmatrix",
@@ -38,7 +46,8 @@ INITIALIZE_PASS_END(LiveRegMatrix, "liveregmatrix",
                     "Live Register Matrix", false, false)
 
 LiveRegMatrix::LiveRegMatrix() : MachineFunctionPass(ID),
-  UserTag(0), RegMaskTag(0), RegMaskVirtReg(0) {}
+  UserTag(0), RegMaskTag(0), RegMaskVirtReg(0), NumBlocks(0),
+  LiveBlocksTag(0), LiveBlocksVirtReg(0), LiveBlocksSize(0) {}
 
 void LiveRegMatrix::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
@@ -57,6 +66,9 @@ bool LiveRegMatrix::runOnMachineFunction(MachineFunction &MF) {
   if (NumRegUnits != Matrix.size())
     Queries.reset(new LiveIntervalUnion::Query[NumRegUnits]);
   Matrix.init(LIUAlloc, NumRegUnits);
+  UnitBlockUse.clear();
+  UnitBlockUse.resize(NumRegUnits);
+  NumBlocks = MF.getNumBlockIDs();
 
   // Make sure no stale queries get reused.
   invalidateVirtRegs();
@@ -70,6 +82,76 @@ void LiveRegMatrix::releaseMemory() {
     // have anything important to clear and LiveRegMatrix's runOnFunction()
     // does a std::unique_ptr::reset anyways.
   }
+  UnitBlockUse.clear();
+  LiveBlocksVirtReg = 0;
+}
+
+void LiveRegMatrix::collectLiveBlocks(const LiveInterval &VirtReg,
+                                      SmallVectorImpl<unsigned> &Blocks) const {
+  const SlotIndexes &Indexes = *LIS->getSlotIndexes();
+  Blocks.clear();
+  for (LiveInterval::const_iterator I = VirtReg.begin(), E = VirtReg.end();
+       I != E; ++I) {
+    const MachineBasicBlock *First = Indexes.getMBBFromIndex(I->start);
+    MachineFunction::const_iterator MBB = First;
+    MachineFunction::const_iterator MBBE = First->getParent()->end();
+    (void)MBBE;
+    for (;;) {
+      // Segments are sorted and the blocks are visited in layout order, so
+      // duplicates are always adjacent.
+      unsigned Num = MBB->getNumber();
+      if (Blocks.empty() || Blocks.back() != Num)
+        Blocks.push_back(Num);
+      if (I->end <= Indexes.getMBBEndIdx(MBB))
+        break;
+      ++MBB;
+      assert(MBB != MBBE && "Segment extends past the last block");
+    }
+  }
+}
+
+const SmallVectorImpl<unsigned> &
+LiveRegMatrix::getLiveBlocks(const LiveInterval &VirtReg) {
+  if (LiveBlocksVirtReg != VirtReg.reg || LiveBlocksTag != UserTag ||
+      LiveBlocksSize != VirtReg.size() ||
+      LiveBlocksStart != VirtReg.beginIndex() ||
+      LiveBlocksEnd != VirtReg.endIndex()) {
+    LiveBlocksVirtReg = VirtReg.reg;
+    LiveBlocksTag = UserTag;
+    LiveBlocksSize = VirtReg.size();
+    LiveBlocksStart = VirtReg.beginIndex();
+    LiveBlocksEnd = VirtReg.endIndex();
+    collectLiveBlocks(VirtReg, LiveBlocks);
+  }
+  return LiveBlocks;
+}
+
+void LiveRegMatrix::updateBlockUse(const SmallVectorImpl<unsigned> &Blocks,
+                                   unsigned PhysReg, int Delta) {
+  if (Blocks.empty())
+    return;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    std::vector<unsigned> &Use = UnitBlockUse[*Units];
+    if (Use.size() < NumBlocks)
+      Use.resize(NumBlocks);
+    for (unsigned i = 0, e = Blocks.size(); i != e; ++i) {
+      assert(Blocks[i] < Use.size() && "Block number out of range");
+      assert((Delta > 0 || Use[Blocks[i]]) && "Block use count underflow");
+      Use[Blocks[i]] += Delta;
+    }
+  }
+}
+
+bool LiveRegMatrix::isUnitUsedInBlocks(unsigned RegUnit,
+                                       const SmallVectorImpl<unsigned> &Blocks)
+                                       const {
+  const std::vector<unsigned> &Use = UnitBlockUse[RegUnit];
+  if (Use.empty())
+    return false;
+  for (unsigned i = 0, e = Blocks.size(); i != e; ++i)
+    if (Use[Blocks[i]])
+      return true;
+  return false;
 }
 
 void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
@@ -82,6 +164,9 @@ void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
     DEBUG(dbgs() << ' ' << PrintRegUnit(*Units, TRI));
     Matrix[*Units].unify(VirtReg);
   }
+  SmallVector<unsigned, 16> Blocks;
+  collectLiveBlocks(VirtReg, Blocks);
+  updateBlockUse(Blocks, PhysReg, 1);
   ++NumAssigned;
   DEBUG(dbgs() << '\n');
 }
@@ -95,6 +180,9 @@ void LiveRegMatrix::unassign(LiveInterval &VirtReg) {
     DEBUG(dbgs() << ' ' << PrintRegUnit(*Units, TRI));
     Matrix[*Units].extract(VirtReg);
   }
+  SmallVector<unsigned, 16> Blocks;
+  collectLiveBlocks(VirtReg, Blocks);
+  updateBlockUse(Blocks, PhysReg, -1);
   ++NumUnassigned;
   DEBUG(dbgs() << '\n');
 }
@@ -150,10 +238,22 @@ LiveRegMatrix::checkInterference(LiveInterval &VirtReg, unsigned PhysReg) {
   if (checkRegUnitInterference(VirtReg, PhysReg))
     return IK_RegUnit;
 
-  // Check the matrix for virtual register interference.
-  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
+  // Check the matrix for virtual register interference. Units that have
+  // nothing assigned in the blocks VirtReg is live in can't interfere, and
+  // are skipped without searching their LiveIntervalUnion.
+  const SmallVectorImpl<unsigned> *Blocks = nullptr;
+  if (!DisableBlockFilter)
+    Blocks = &getLiveBlocks(VirtReg);
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    if (Blocks && !isUnitUsedInBlocks(*Units, *Blocks)) {
+      assert(!query(VirtReg, *Units).checkInterference() &&
+             "Block filter missed interference");
+      ++NumBlockFiltered;
+      continue;
+    }
     if (query(VirtReg, *Units).checkInterference())
       return IK_VirtReg;
+  }
 
   return IK_Free;
 }
@@ -53,6 +53,8 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumWorkUnits,    "Work spent searching for evictions and splits");
+STATISTIC(NumOverBudget,   "Number of functions exceeding the work budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode>
 SplitSpillMode("split-spill-mode", cl::Hidden,
@@ -79,6 +81,17 @@ ExhaustiveSearch("exhaustive-register-search", cl::NotHidden,
                  cl::desc("Exhaustive Search for registers bypassing the depth "
                           "and interference cutoffs of last chance recoloring"));
 
+static cl::opt<unsigned>
+WorkBudget("regalloc-greedy-budget", cl::Hidden,
+           cl::desc("Fall back to cheaper splitting, then to spilling, once "
+                    "this much work was spent on a function (0 = unlimited)"),
+           cl::init(0));
+
+static cl::opt<bool>
+ReportWork("regalloc-greedy-report-work", cl::Hidden,
+           cl::desc("Report the work spent on each function"),
+           cl::init(false));
+
 // FIXME: Find a good default for this flag and remove the flag.
 static cl::opt<unsigned>
 CSRFirstTimeCost("regalloc-csr-first-time-cost",
@@ -171,6 +184,21 @@ class RAGreedy : public MachineFunctionPass,
 
   uint8_t CutOffInfo;
 
+  // Work spent in the eviction and splitting searches of the current
+  // function, in units of candidate registers, interfering ranges, blocks and
+  // use gaps examined.  Once it passes -regalloc-greedy-budget, global region
+  // splitting is skipped; at twice the budget, spillable ranges are spilled
+  // without searching for evictions or splits.
+  uint64_t WorkUsed;
+
+  void chargeWork(uint64_t Units) { WorkUsed += Units; }
+
+  bool isOverBudget() const { return WorkBudget && WorkUsed >= WorkBudget; }
+
+  bool isFarOverBudget() const {
+    return WorkBudget && WorkUsed >= 2 * uint64_t(WorkBudget);
+  }
+
 #ifndef NDEBUG
   static const char *const StageName[];
 #endif
@@ -684,7 +712,9 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
     // If there is 10 or more interferences, chances are one is heavier.
-    if (Q.collectInterferingVRegs(10) >= 10)
+    unsigned NumIntf = Q.collectInterferingVRegs(10);
+    chargeWork(NumIntf);
+    if (NumIntf >= 10)
       return false;
 
     // Check if any interfering live range is heavier than MaxWeight.
@@ -790,6 +820,11 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
                             unsigned CostPerUseLimit) {
   NamedRegionTimer T("Evict", TimerGroupName, TimePassesIsEnabled);
 
+  // Unspillable ranges depend on eviction to make progress, so only give up
+  // on ranges that can still be spilled.
+  if (isFarOverBudget() && VirtReg.isSpillable())
+    return 0;
+
   // Keep track of the cheapest interference seen so far.
   EvictionCost BestCost;
   BestCost.setMax();
@@ -821,6 +856,7 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
 
   Order.rewind();
   while (unsigned PhysReg = Order.next(OrderLimit)) {
+    chargeWork(1);
     if (TRI->getCostPerUse(PhysReg) >= CostPerUseLimit)
       continue;
     // The first use of a callee-saved register in a function has cost 1.
@@ -1314,6 +1350,10 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
   unsigned BestCand = NoCand;
   Order.rewind();
   while (unsigned PhysReg = Order.next()) {
+    // Settle for the best candidate so far once the budget is spent.
+    if (isOverBudget())
+      break;
+    chargeWork(1 + SA->getUseBlocks().size());
    if (unsigned CSR = RegClassInfo.getLastCalleeSavedAlias(PhysReg))
      if (IgnoreCSR && !MRI->isPhysRegUsed(CSR))
        continue;
@@ -1360,6 +1400,7 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
       continue;
     }
     growRegion(Cand);
+    chargeWork(Cand.ActiveBlocks.size());
 
     SpillPlacer->finish();
 
@@ -1732,6 +1773,8 @@ unsigned RAGreedy::tryLocalSplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   Order.rewind();
   while (unsigned PhysReg = Order.next()) {
+    chargeWork(1 + NumGaps);
+
     // Keep track of the largest spill weight that would need to be evicted in
     // order to make use of PhysReg between UseSlots[i] and UseSlots[i+1].
     calcGapWeights(PhysReg, GapWeight);
@@ -1877,6 +1920,10 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (getStage(VirtReg) >= RS_Spill)
     return 0;
 
+  // Far over budget, spill instead of searching for a split.
+  if (isFarOverBudget())
+    return 0;
+
   // Local intervals are handled separately.
   if (LIS->intervalIsInOneMBB(VirtReg)) {
     NamedRegionTimer T("Local Splitting", TimerGroupName, TimePassesIsEnabled);
@@ -1904,8 +1951,9 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   // First try to split around a region spanning multiple blocks. RS_Split2
   // ranges already made dubious progress with region splitting, so they go
-  // straight to single block splitting.
-  if (getStage(VirtReg) < RS_Split2) {
+  // straight to single block splitting, as does everything once the work
+  // budget is spent.
+  if (getStage(VirtReg) < RS_Split2 && !isOverBudget()) {
     unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
       return PhysReg;
@@ -2339,8 +2387,20 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   NextCascade = 1;
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
+  WorkUsed = 0;
 
   allocatePhysRegs();
+
+  NumWorkUnits += WorkUsed;
+  if (isOverBudget())
+    ++NumOverBudget;
+  if (ReportWork) {
+    errs() << "greedy: " << mf.getName() << ": " << WorkUsed << " work units";
+    if (isOverBudget())
+      errs() << ", over budget";
+    errs() << '\n';
+  }
+
   releaseMemory();
   return true;
 }
@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -94,18 +95,14 @@ namespace {
     // also only appear once. The naive approach to this takes
     // linear time.
     //
-    // To reduce the insert/remove time to logarithmic, we use
-    // a set and a vector to maintain our worklist.
-    //
-    // The set contains the items on the worklist, but does not
-    // maintain the order they should be visited.
-    //
-    // The vector maintains the order nodes should be visited, but may
-    // contain duplicate or removed nodes. When choosing a node to
-    // visit, we pop off the order stack until we find an item that is
-    // also in the contents set. All operations are O(log N).
-    SmallPtrSet<SDNode*, 64> WorkListContents;
+    // WorkListOrder holds the nodes in the order they should be visited, and
+    // WorkListMap maps each node on the worklist to its slot in the vector.
+    // Adding a node that is already on the worklist clears its old slot
+    // before appending it again, and removing a node clears its slot, so no
+    // node is ever queued twice. Cleared slots are skipped when choosing the
+    // next node to visit. All operations are O(1).
     SmallVector<SDNode*, 64> WorkListOrder;
+    DenseMap<SDNode*, unsigned> WorkListMap;
 
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis &AA;
@@ -127,14 +124,40 @@ namespace {
     /// AddToWorkList - Add to the work list making sure its instance is at the
     /// back (next to be processed.)
     void AddToWorkList(SDNode *N) {
-      WorkListContents.insert(N);
+      std::pair<DenseMap<SDNode*, unsigned>::iterator, bool> InsertResult =
+        WorkListMap.insert(std::make_pair(N, WorkListOrder.size()));
+      if (!InsertResult.second) {
+        unsigned &Slot = InsertResult.first->second;
+        if (Slot + 1 == WorkListOrder.size())
+          return;
+        WorkListOrder[Slot] = nullptr;
+        Slot = WorkListOrder.size();
+      }
       WorkListOrder.push_back(N);
     }
 
-    /// removeFromWorkList - remove all instances of N from the worklist.
+    /// removeFromWorkList - remove N from the worklist.
     ///
     void removeFromWorkList(SDNode *N) {
-      WorkListContents.erase(N);
+      DenseMap<SDNode*, unsigned>::iterator I = WorkListMap.find(N);
+      if (I == WorkListMap.end())
+        return;
+      WorkListOrder[I->second] = nullptr;
+      WorkListMap.erase(I);
+    }
+
+    /// getNextWorkListEntry - remove and return the node to visit next, or
+    /// null if the worklist is empty.
+    SDNode *getNextWorkListEntry() {
+      while (!WorkListOrder.empty()) {
+        SDNode *N = WorkListOrder.pop_back_val();
+        if (!N)
+          continue;
+        WorkListMap.erase(N);
+        return N;
+      }
+      assert(WorkListMap.empty() && "Worklist map out of sync");
+      return nullptr;
     }
 
     SDValue CombineTo(SDNode *N, const SDValue *To, unsigned NumTo,
@@ -1100,17 +1123,7 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
   // while the worklist isn't empty, find a node and
   // try and combine it.
-  while (!WorkListContents.empty()) {
-    SDNode *N;
-    // The WorkListOrder holds the SDNodes in order, but it may contain
-    // duplicates.
-    // In order to avoid a linear scan, we use a set (O(log N)) to hold what the
-    // worklist *should* contain, and check the node we want to visit is should
-    // actually be visited.
-    do {
-      N = WorkListOrder.pop_back_val();
-    } while (!WorkListContents.erase(N));
-
+  while (SDNode *N = getNextWorkListEntry()) {
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
     // reduced number of uses, allowing other xforms.
@@ -422,7 +422,30 @@ DWARFCompileUnit *DWARFContext::getCompileUnitForAddress(uint64_t Address) {
   // First, get the offset of the compile unit.
   uint32_t CUOffset = getDebugAranges()->findAddress(Address);
   // Retrieve the compile unit.
-  return getCompileUnitForOffset(CUOffset);
+  DWARFCompileUnit *CU = getCompileUnitForOffset(CUOffset);
+  if (CU)
+    noteCompileUnitUsed(CU);
+  return CU;
+}
+
+void DWARFContext::noteCompileUnitUsed(DWARFCompileUnit *CU) {
+  auto I = std::find(RecentCUs.begin(), RecentCUs.end(), CU);
+  if (I != RecentCUs.end()) {
+    std::rotate(RecentCUs.begin(), I, I + 1);
+    return;
+  }
+  RecentCUs.insert(RecentCUs.begin(), CU);
+  if (RecentCUs.size() <= MaxRecentCUs)
+    return;
+  DWARFCompileUnit *Evicted = RecentCUs.pop_back_val();
+  const DWARFDebugInfoEntryMinimal *CUDIE = Evicted->getCompileUnitDIE();
+  if (Line && CUDIE) {
+    uint32_t StmtOffset =
+        CUDIE->getAttributeValueAsSectionOffset(Evicted, DW_AT_stmt_list, -1U);
+    if (StmtOffset != -1U)
+      Line->clearLineTable(StmtOffset);
+  }
+  Evicted->releaseDIEs();
 }
 
 static bool getFileNameForCompileUnit(DWARFCompileUnit *CU,
@@ -44,6 +44,12 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugAbbrev> AbbrevDWO;
   std::unique_ptr<DWARFDebugLocDWO> LocDWO;
 
+  /// Compile units recently used for address lookups, most recent first.
+  /// Only these keep their DIEs and line tables parsed, so that memory usage
+  /// does not grow with the number of compile units queried.
+  SmallVector<DWARFCompileUnit *, 16> RecentCUs;
+  static const unsigned MaxRecentCUs = 16;
+
   DWARFContext(DWARFContext &) LLVM_DELETED_FUNCTION;
   DWARFContext &operator=(DWARFContext &) LLVM_DELETED_FUNCTION;
 
@@ -208,6 +214,10 @@ private:
   /// Return the compile unit which contains instruction with provided
   /// address.
   DWARFCompileUnit *getCompileUnitForAddress(uint64_t Address);
+
+  /// Mark \p CU as the most recently used compile unit, releasing the DIEs
+  /// and line table of the least recently used one if there are too many.
+  void noteCompileUnitUsed(DWARFCompileUnit *CU);
 };
 
 /// DWARFContextInMemory is the simplest possible implementation of a
@@ -202,6 +202,9 @@ public:
   const LineTable *getLineTable(uint32_t offset) const;
   const LineTable *getOrParseLineTable(DataExtractor debug_line_data,
                                        uint32_t offset);
+  /// Drops the cached line table at \p offset, if any. Pointers to it become
+  /// invalid.
+  void clearLineTable(uint32_t offset) { LineTableMap.erase(offset); }
 
 private:
   struct ParsingState {
@@ -12,7 +12,9 @@
 #include "llvm/DebugInfo/DWARFFormValue.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 #include <cstdio>
+#include <tuple>
 
 using namespace llvm;
 using namespace dwarf;
@@ -297,6 +299,13 @@ void DWARFUnit::clearDIEs(bool KeepCUDie) {
     if (KeepCUDie)
       DieArray.push_back(TmpArray.front());
   }
+  std::vector<SubprogramRange>().swap(SubprogramRanges);
+  HasSubprogramRanges = false;
+}
+
+void DWARFUnit::releaseDIEs() {
+  clearDIEs(true);
+  DWO.reset();
 }
 
 void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
@@ -329,16 +338,53 @@ void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
     clearDIEs(true);
 }
 
+void DWARFUnit::buildSubprogramRanges() {
+  SubprogramRanges.clear();
+  for (uint32_t i = 0, e = DieArray.size(); i != e; ++i) {
+    const DWARFDebugInfoEntryMinimal &DIE = DieArray[i];
+    if (!DIE.isSubprogramDIE())
+      continue;
+    for (const auto &R : DIE.getAddressRanges(this)) {
+      if (R.first >= R.second)
+        continue;
+      SubprogramRange SR = { R.first, R.second, 0, i };
+      SubprogramRanges.push_back(SR);
+    }
+  }
+  std::sort(SubprogramRanges.begin(), SubprogramRanges.end(),
+            [](const SubprogramRange &LHS, const SubprogramRange &RHS) {
+    return std::tie(LHS.LowPC, LHS.DIEIndex) < std::tie(RHS.LowPC, RHS.DIEIndex);
+  });
+  uint64_t MaxHighPC = 0;
+  for (SubprogramRange &SR : SubprogramRanges) {
+    MaxHighPC = std::max(MaxHighPC, SR.HighPC);
+    SR.MaxHighPC = MaxHighPC;
+  }
+  HasSubprogramRanges = true;
+}
+
 const DWARFDebugInfoEntryMinimal *
 DWARFUnit::getSubprogramForAddress(uint64_t Address) {
   extractDIEsIfNeeded(false);
-  for (const DWARFDebugInfoEntryMinimal &DIE : DieArray) {
-    if (DIE.isSubprogramDIE() &&
-        DIE.addressRangeContainsAddress(this, Address)) {
-      return &DIE;
-    }
+  if (!HasSubprogramRanges)
+    buildSubprogramRanges();
+  // Every range before the upper bound starts at or before Address. Walk them
+  // backwards until no earlier range can reach Address, and prefer the
+  // subprogram that comes first in the unit, as a linear scan would.
+  auto It = std::upper_bound(
+      SubprogramRanges.begin(), SubprogramRanges.end(), Address,
+      [](uint64_t Addr, const SubprogramRange &SR) { return Addr < SR.LowPC; });
+  uint32_t DIEIndex = -1U;
+  while (It != SubprogramRanges.begin()) {
+    --It;
+    if (It->MaxHighPC <= Address)
+      break;
+    if (Address < It->HighPC)
+      DIEIndex = std::min(DIEIndex, It->DIEIndex);
   }
-  return nullptr;
+  if (DIEIndex == -1U)
+    return nullptr;
+  return &DieArray[DIEIndex];
 }
 
 DWARFDebugInfoEntryInlinedChain
@@ -47,6 +47,20 @@ class DWARFUnit {
   // The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntryMinimal> DieArray;
 
+  /// SubprogramRange - an address range of a subprogram DIE in DieArray.
+  struct SubprogramRange {
+    uint64_t LowPC;
+    uint64_t HighPC;
+    // Largest HighPC of this range and all ranges sorted before it. Bounds
+    // the backward scan over overlapping ranges.
+    uint64_t MaxHighPC;
+    uint32_t DIEIndex;
+  };
+  /// Address ranges of all subprogram DIEs, sorted by LowPC. Built on the
+  /// first address lookup and dropped together with the DIEs.
+  std::vector<SubprogramRange> SubprogramRanges;
+  bool HasSubprogramRanges;
+
   class DWOHolder {
     std::unique_ptr<object::ObjectFile> DWOFile;
     std::unique_ptr<DWARFContext> DWOContext;
@@ -131,6 +145,12 @@ public:
   /// chain is valid as long as parsed compile unit DIEs are not cleared.
   DWARFDebugInfoEntryInlinedChain getInlinedChainForAddress(uint64_t Address);
 
+  /// releaseDIEs - Drops all parsed DIEs except the compile unit DIE, the
+  /// indexes built over them and the parsed .dwo unit, to keep memory usage
+  /// low. Pointers to the dropped DIEs become invalid; they are parsed again
+  /// on the next request.
+  void releaseDIEs();
+
 private:
   /// Size in bytes of the .debug_info data associated with this compile unit.
   size_t getDebugInfoSize() const { return Length + 4 - getHeaderSize(); }
@@ -148,6 +168,9 @@ private:
   /// clearDIEs - Clear parsed DIEs to keep memory usage low.
   void clearDIEs(bool KeepCUDie);
 
+  /// buildSubprogramRanges - Fills SubprogramRanges from the parsed DIEs.
+  void buildSubprogramRanges();
+
   /// parseDWO - Parses .dwo file for current compile unit. Returns true if
   /// it was actually constructed.
   bool parseDWO();
@@ -364,42 +364,48 @@ int ExecutionEngine::runFunctionAsMain(Function *Fn,
                                        const std::vector<std::string> &argv,
                                        const char * const * envp) {
   std::vector<GenericValue> GVArgs;
-  GenericValue GVArgc;
-  GVArgc.IntVal = APInt(32, argv.size());
-
-  // Check main() type
-  unsigned NumArgs = Fn->getFunctionType()->getNumParams();
-  FunctionType *FTy = Fn->getFunctionType();
-  Type* PPInt8Ty = Type::getInt8PtrTy(Fn->getContext())->getPointerTo();
-
-  // Check the argument types.
-  if (NumArgs > 3)
-    report_fatal_error("Invalid number of arguments of main() supplied");
-  if (NumArgs >= 3 && FTy->getParamType(2) != PPInt8Ty)
-    report_fatal_error("Invalid type for third argument of main() supplied");
-  if (NumArgs >= 2 && FTy->getParamType(1) != PPInt8Ty)
-    report_fatal_error("Invalid type for second argument of main() supplied");
-  if (NumArgs >= 1 && !FTy->getParamType(0)->isIntegerTy(32))
-    report_fatal_error("Invalid type for first argument of main() supplied");
-  if (!FTy->getReturnType()->isIntegerTy() &&
-      !FTy->getReturnType()->isVoidTy())
-    report_fatal_error("Invalid return type of main() supplied");
-
   ArgvArray CArgv;
   ArgvArray CEnv;
-  if (NumArgs) {
-    GVArgs.push_back(GVArgc); // Arg #0 = argc.
-    if (NumArgs > 1) {
-      // Arg #1 = argv.
-      GVArgs.push_back(PTOGV(CArgv.reset(Fn->getContext(), this, argv)));
-      assert(!isTargetNullPtr(this, GVTOP(GVArgs[1])) &&
-             "argv[0] was null after CreateArgv");
-      if (NumArgs > 2) {
-        std::vector<std::string> EnvVars;
-        for (unsigned i = 0; envp[i]; ++i)
-          EnvVars.push_back(envp[i]);
-        // Arg #2 = envp.
-        GVArgs.push_back(PTOGV(CEnv.reset(Fn->getContext(), this, EnvVars)));
+  {
+    // The engine may be compiling on another thread, and looking up types
+    // touches the context.
+    MutexGuard locked(lock);
+
+    GenericValue GVArgc;
+    GVArgc.IntVal = APInt(32, argv.size());
+
+    // Check main() type
+    unsigned NumArgs = Fn->getFunctionType()->getNumParams();
+    FunctionType *FTy = Fn->getFunctionType();
+    Type* PPInt8Ty = Type::getInt8PtrTy(Fn->getContext())->getPointerTo();
+
+    // Check the argument types.
+    if (NumArgs > 3)
+      report_fatal_error("Invalid number of arguments of main() supplied");
+    if (NumArgs >= 3 && FTy->getParamType(2) != PPInt8Ty)
+      report_fatal_error("Invalid type for third argument of main() supplied");
+    if (NumArgs >= 2 && FTy->getParamType(1) != PPInt8Ty)
+      report_fatal_error("Invalid type for second argument of main() supplied");
+    if (NumArgs >= 1 && !FTy->getParamType(0)->isIntegerTy(32))
+      report_fatal_error("Invalid type for first argument of main() supplied");
+    if (!FTy->getReturnType()->isIntegerTy() &&
+        !FTy->getReturnType()->isVoidTy())
+      report_fatal_error("Invalid return type of main() supplied");
+
+    if (NumArgs) {
+      GVArgs.push_back(GVArgc); // Arg #0 = argc.
+      if (NumArgs > 1) {
+        // Arg #1 = argv.
+        GVArgs.push_back(PTOGV(CArgv.reset(Fn->getContext(), this, argv)));
+        assert(!isTargetNullPtr(this, GVTOP(GVArgs[1])) &&
+               "argv[0] was null after CreateArgv");
+        if (NumArgs > 2) {
+          std::vector<std::string> EnvVars;
+          for (unsigned i = 0; envp[i]; ++i)
+            EnvVars.push_back(envp[i]);
+          // Arg #2 = envp.
+          GVArgs.push_back(PTOGV(CEnv.reset(Fn->getContext(), this, EnvVars)));
+        }
       }
     }
   }
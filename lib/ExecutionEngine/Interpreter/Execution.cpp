@@ -38,8 +38,15 @@ static cl::opt<bool> PrintVolatile("interpreter-print-volatile", cl::Hidden,
 //                     Various Helper Functions
 //===----------------------------------------------------------------------===//
 
+static GenericValue &getFrameValue(Value *V, ExecutionContext &SF) {
+  unsigned Slot = SF.Layout->getSlot(V);
+  if (Slot >= SF.Values.size())
+    SF.Values.resize(SF.Layout->getNumSlots());
+  return SF.Values[Slot];
+}
+
 static void SetValue(Value *V, GenericValue Val, ExecutionContext &SF) {
-  SF.Values[V] = Val;
+  getFrameValue(V, SF) = std::move(Val);
 }
 
 //===----------------------------------------------------------------------===//
@@ -2054,15 +2061,40 @@ GenericValue Interpreter::getConstantExprValue (ConstantExpr *CE,
 }
 
 GenericValue Interpreter::getOperandValue(Value *V, ExecutionContext &SF) {
-  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V)) {
-    return getConstantExprValue(CE, SF);
-  } else if (Constant *CPV = dyn_cast<Constant>(V)) {
-    return getConstantValue(CPV);
-  } else if (GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
-    return PTOGV(getPointerToGlobal(GV));
-  } else {
-    return SF.Values[V];
-  }
+  Constant *CPV = dyn_cast<Constant>(V);
+  if (!CPV)
+    return getFrameValue(V, SF);
+
+  // Constants are evaluated the first time the function uses them.
+  DenseMap<const Constant *, GenericValue>::iterator I =
+      SF.Layout->Constants.find(CPV);
+  if (I != SF.Layout->Constants.end())
+    return I->second;
+
+  GenericValue Result;
+  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(CPV))
+    Result = getConstantExprValue(CE, SF);
+  else
+    Result = getConstantValue(CPV);
+  SF.Layout->Constants[CPV] = Result;
+  return Result;
+}
+
+FrameLayout::FrameLayout(const Function &F) {
+  for (Function::const_arg_iterator AI = F.arg_begin(), E = F.arg_end();
+       AI != E; ++AI)
+    getSlot(AI);
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I)
+      getSlot(I);
+}
+
+FrameLayout &Interpreter::getFrameLayout(Function *F) {
+  FrameLayout *&Layout = FrameLayouts[F];
+  if (!Layout)
+    Layout = new FrameLayout(*F);
+  return *Layout;
 }
 
 //===----------------------------------------------------------------------===//
@@ -2094,6 +2126,10 @@ void Interpreter::callFunction(Function *F,
   StackFrame.CurBB     = F->begin();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
 
+  // Make room for every value the function computes.
+  StackFrame.Layout = &getFrameLayout(F);
+  StackFrame.Values.resize(StackFrame.Layout->getNumSlots());
+
   // Run through the function arguments and initialize their values...
   assert((ArgVals.size() == F->arg_size() ||
          (ArgVals.size() > F->arg_size() && F->getFunctionType()->isVarArg()))&&
@@ -2127,7 +2163,7 @@ DEBUG(
     if (!isa<CallInst>(I) && !isa<InvokeInst>(I) && 
         I.getType() != Type::VoidTy) {
       dbgs() << "  --> ";
-      const GenericValue &Val = SF.Values[&I];
+      const GenericValue &Val = getFrameValue(&I, SF);
       switch (I.getType()->getTypeID()) {
       default: llvm_unreachable("Invalid GenericValue Type");
       case Type::VoidTyID:    dbgs() << "void"; break;
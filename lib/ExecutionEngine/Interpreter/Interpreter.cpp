@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Interpreter.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/CodeGen/IntrinsicLowering.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Module.h"
@@ -62,6 +63,15 @@ Interpreter::Interpreter(Module *M)
 
 Interpreter::~Interpreter() {
   delete IL;
+  DeleteContainerSeconds(FrameLayouts);
+}
+
+void Interpreter::freeMachineCodeForFunction(Function *F) {
+  DenseMap<const Function *, FrameLayout *>::iterator I = FrameLayouts.find(F);
+  if (I == FrameLayouts.end())
+    return;
+  delete I->second;
+  FrameLayouts.erase(I);
 }
 
 void Interpreter::runAtExitHandlers () {
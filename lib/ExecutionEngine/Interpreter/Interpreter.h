@@ -14,6 +14,7 @@
 #ifndef LLI_INTERPRETER_H
 #define LLI_INTERPRETER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/IR/CallSite.h"
@@ -64,6 +65,26 @@ public:
 
 typedef std::vector<GenericValue> ValuePlaneTy;
 
+// FrameLayout - Assigns each argument and instruction of a function a slot in
+// the value plane of its stack frames, and caches the values of the constants
+// the function uses.  Built the first time the function is called.
+//
+class FrameLayout {
+  DenseMap<const Value *, unsigned> Slots;
+public:
+  DenseMap<const Constant *, GenericValue> Constants;
+
+  explicit FrameLayout(const Function &F);
+
+  unsigned getNumSlots() const { return Slots.size(); }
+
+  // getSlot - Return the slot of V.  Instructions inserted by intrinsic
+  // lowering after the layout was built are numbered as they are first seen.
+  unsigned getSlot(const Value *V) {
+    return Slots.insert(std::make_pair(V, Slots.size())).first->second;
+  }
+};
+
 // ExecutionContext struct - This struct represents one stack frame currently
 // executing.
 //
@@ -71,7 +92,8 @@ struct ExecutionContext {
   Function             *CurFunction;// The currently executing function
   BasicBlock           *CurBB;      // The currently executing BB
   BasicBlock::iterator  CurInst;    // The next instruction to execute
-  std::map<Value *, GenericValue> Values; // LLVM values used in this invocation
+  FrameLayout          *Layout;     // The slot numbering of CurFunction
+  ValuePlaneTy          Values;     // LLVM values used in this invocation
   std::vector<GenericValue>  VarArgs; // Values passed through an ellipsis
   CallSite             Caller;     // Holds the call that called subframes.
                                    // NULL if main func or debugger invoked fn
@@ -93,6 +115,9 @@ class Interpreter : public ExecutionEngine, public InstVisitor<Interpreter> {
   // registered with the atexit() library function.
   std::vector<Function*> AtExitHandlers;
 
+  // FrameLayouts - The layout of each function that has been called.
+  DenseMap<const Function *, FrameLayout *> FrameLayouts;
+
 public:
   explicit Interpreter(Module *M);
   ~Interpreter();
@@ -128,9 +153,10 @@ public:
     return getPointerToFunction(F);
   }
 
-  /// freeMachineCodeForFunction - The interpreter does not generate any code.
+  /// freeMachineCodeForFunction - The interpreter does not generate any code,
+  /// but drop the frame layout in case the function is about to change.
   ///
-  void freeMachineCodeForFunction(Function *F) override { }
+  void freeMachineCodeForFunction(Function *F) override;
 
   // Methods used to execute code:
   // Place a call on the stack
@@ -219,6 +245,7 @@ private:  // Helper functions
   void initializeExternalFunctions();
   GenericValue getConstantExprValue(ConstantExpr *CE, ExecutionContext &SF);
   GenericValue getOperandValue(Value *V, ExecutionContext &SF);
+  FrameLayout &getFrameLayout(Function *F);
   GenericValue executeTruncInst(Value *SrcVal, Type *DstTy,
                                 ExecutionContext &SF);
   GenericValue executeSExtInst(Value *SrcVal, Type *DstTy,
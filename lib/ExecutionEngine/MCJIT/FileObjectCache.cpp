@@ -0,0 +1,233 @@
+//===-- FileObjectCache.cpp - Persistent on-disk ObjectCache --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements FileObjectCache, which stores objects generated by
+// MCJIT in a directory, keyed by a hash of the module and the target.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/FileObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+
+using namespace llvm;
+
+static const char ObjectSuffix[] = ".o";
+
+FileObjectCache::FileObjectCache(StringRef CacheDir, const TargetMachine &TM,
+                                 uint64_t MaxCacheSize)
+    : CacheDir(CacheDir), TM(TM), MaxCacheSize(MaxCacheSize) {
+  // Enforce the limit even if this run only hits in the cache, or the limit
+  // is smaller than it was when the objects were stored.
+  pruneCache();
+}
+
+FileObjectCache::~FileObjectCache() {}
+
+static void hashField(MD5 &Hash, StringRef Field) {
+  Hash.update(Field);
+  // Separate the fields so that e.g. ("ab", "c") and ("a", "bc") differ.
+  Hash.update(StringRef("", 1));
+}
+
+static void hashField(MD5 &Hash, uint64_t Field) {
+  uint8_t Bytes[8];
+  for (unsigned I = 0; I != 8; ++I)
+    Bytes[I] = uint8_t(Field >> (I * 8));
+  Hash.update(Bytes);
+}
+
+std::string FileObjectCache::getCacheKey(const Module *M) const {
+  MD5 Hash;
+
+  // Objects from a different compiler may not be interchangeable.
+  hashField(Hash, LLVM_VERSION_MAJOR);
+  hashField(Hash, LLVM_VERSION_MINOR);
+
+  hashField(Hash, TM.getTargetTriple());
+  hashField(Hash, TM.getTargetCPU());
+  hashField(Hash, TM.getTargetFeatureString());
+  hashField(Hash, TM.getOptLevel());
+  hashField(Hash, TM.getRelocationModel());
+  hashField(Hash, TM.getCodeModel());
+
+  const TargetOptions &Opts = TM.Options;
+  uint64_t Flags = 0;
+  unsigned Bit = 0;
+  Flags |= uint64_t(Opts.NoFramePointerElim) << Bit++;
+  Flags |= uint64_t(Opts.LessPreciseFPMADOption) << Bit++;
+  Flags |= uint64_t(Opts.UnsafeFPMath) << Bit++;
+  Flags |= uint64_t(Opts.NoInfsFPMath) << Bit++;
+  Flags |= uint64_t(Opts.NoNaNsFPMath) << Bit++;
+  Flags |= uint64_t(Opts.HonorSignDependentRoundingFPMathOption) << Bit++;
+  Flags |= uint64_t(Opts.UseSoftFloat) << Bit++;
+  Flags |= uint64_t(Opts.NoZerosInBSS) << Bit++;
+  Flags |= uint64_t(Opts.JITEmitDebugInfo) << Bit++;
+  Flags |= uint64_t(Opts.GuaranteedTailCallOpt) << Bit++;
+  Flags |= uint64_t(Opts.DisableTailCalls) << Bit++;
+  Flags |= uint64_t(Opts.EnableFastISel) << Bit++;
+  Flags |= uint64_t(Opts.PositionIndependentExecutable) << Bit++;
+  Flags |= uint64_t(Opts.UseInitArray) << Bit++;
+  Flags |= uint64_t(Opts.FunctionSections) << Bit++;
+  Flags |= uint64_t(Opts.DataSections) << Bit++;
+  Flags |= uint64_t(Opts.TrapUnreachable) << Bit++;
+  hashField(Hash, Flags);
+  hashField(Hash, Opts.StackAlignmentOverride);
+  hashField(Hash, Opts.FloatABIType);
+  hashField(Hash, Opts.AllowFPOpFusion);
+
+  SmallString<4096> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+  Hash.update(Bitcode);
+
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+void FileObjectCache::getObjectPath(StringRef Key,
+                                    SmallVectorImpl<char> &Path) const {
+  Path.clear();
+  Path.append(CacheDir.begin(), CacheDir.end());
+  sys::path::append(Path, Twine(Key) + ObjectSuffix);
+}
+
+MemoryBuffer *FileObjectCache::getObject(const Module *M) {
+  std::string Key = getCacheKey(M);
+  SmallString<128> Path;
+  getObjectPath(Key, Path);
+
+  std::unique_ptr<MemoryBuffer> File;
+  if (MemoryBuffer::getFile(Path.str(), File, -1, false)) {
+    // A miss; remember the key so that the compiled object can be stored
+    // under it even though code generation may change the module.
+    PendingKeys[M] = Key;
+    return nullptr;
+  }
+  PendingKeys.erase(M);
+
+  // Mark the object as recently used so pruning keeps it around.
+  int FD;
+  if (!sys::fs::openFileForWrite(Path.str(), FD, sys::fs::F_Append)) {
+    sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+    // Let raw_fd_ostream close the descriptor in a portable way.
+    raw_fd_ostream Closer(FD, /*shouldClose=*/true);
+  }
+
+  // MCJIT writes into the buffer it is given, and the file may be mapped
+  // and shared with other processes, so hand out a copy.
+  return MemoryBuffer::getMemBufferCopy(File->getBuffer(),
+                                        File->getBufferIdentifier());
+}
+
+void FileObjectCache::notifyObjectCompiled(const Module *M,
+                                           const MemoryBuffer *Obj) {
+  std::string Key;
+  DenseMap<const Module *, std::string>::iterator I = PendingKeys.find(M);
+  if (I != PendingKeys.end()) {
+    Key = I->second;
+    PendingKeys.erase(I);
+  } else {
+    Key = getCacheKey(M);
+  }
+
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file first and rename it into place, so that other
+  // users of the cache never see a partially written object.
+  SmallString<128> TempModel(CacheDir);
+  sys::path::append(TempModel, Key + "-%%%%%%.tmp");
+  SmallString<128> TempPath;
+  int FD;
+  if (sys::fs::createUniqueFile(TempModel.str(), FD, TempPath))
+    return;
+
+  bool WriteFailed;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(Obj->getBufferStart(), Obj->getBufferSize());
+    OS.close();
+    WriteFailed = OS.has_error();
+    OS.clear_error();
+  }
+
+  SmallString<128> Path;
+  getObjectPath(Key, Path);
+  if (WriteFailed || sys::fs::rename(TempPath.str(), Path.str())) {
+    sys::fs::remove(TempPath.str());
+    return;
+  }
+
+  if (MaxCacheSize)
+    pruneCache();
+}
+
+namespace {
+struct CachedObject {
+  std::string Path;
+  sys::TimeValue LastUsed;
+  uint64_t Size;
+};
+}
+
+void FileObjectCache::pruneCache() {
+  if (!MaxCacheSize)
+    return;
+
+  std::vector<CachedObject> Objects;
+  uint64_t TotalSize = 0;
+  std::error_code EC;
+  for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    StringRef Path = I->path();
+    if (!Path.endswith(ObjectSuffix))
+      continue;
+    sys::fs::file_status Status;
+    if (I->status(Status) || !sys::fs::is_regular_file(Status))
+      continue;
+    CachedObject Object;
+    Object.Path = Path;
+    Object.LastUsed = Status.getLastModificationTime();
+    Object.Size = Status.getSize();
+    TotalSize += Object.Size;
+    Objects.push_back(Object);
+  }
+
+  if (TotalSize <= MaxCacheSize)
+    return;
+
+  std::sort(Objects.begin(), Objects.end(),
+            [](const CachedObject &A, const CachedObject &B) {
+    return A.LastUsed < B.LastUsed;
+  });
+
+  // Another process may be pruning at the same time, so a failed removal is
+  // not an error; that object simply stops counting against the limit.
+  for (std::vector<CachedObject>::iterator I = Objects.begin(),
+                                           E = Objects.end();
+       I != E && TotalSize > MaxCacheSize; ++I) {
+    sys::fs::remove(I->Path);
+    TotalSize -= I->Size;
+  }
+}
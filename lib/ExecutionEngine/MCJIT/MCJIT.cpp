@@ -23,14 +23,18 @@
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Object/Archive.h"
 #include "llvm/PassManager.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/MutexGuard.h"
 #include "llvm/Target/TargetLowering.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 
 using namespace llvm;
 
+#define DEBUG_TYPE "jit"
+
 namespace {
 
 static struct RegisterJIT {
@@ -59,13 +63,24 @@ ExecutionEngine *MCJIT::createJIT(Module *M,
 MCJIT::MCJIT(Module *m, TargetMachine *tm, RTDyldMemoryManager *MM,
              bool AllocateGVsWithCode)
   : ExecutionEngine(m), TM(tm), Ctx(nullptr), MemMgr(this, MM), Dyld(&MemMgr),
-    ObjCache(nullptr) {
+    ObjCache(nullptr), LazyFunctionCompilation(false), NumSplitModules(0),
+    ShuttingDown(false) {
 
   OwnedModules.addModule(m);
   setDataLayout(TM->getDataLayout());
 }
 
 MCJIT::~MCJIT() {
+  // Let the background compiler finish the function it is working on, and
+  // drop the rest of the queue.
+  if (BackgroundCompiler) {
+    {
+      MutexGuard locked(lock);
+      ShuttingDown = true;
+    }
+    BackgroundCompiler->wait();
+  }
+
   MutexGuard locked(lock);
   // FIXME: We are managing our modules, so we do not want the base class
   // ExecutionEngine to manage them as well. To avoid double destruction
@@ -104,6 +119,8 @@ MCJIT::~MCJIT() {
 void MCJIT::addModule(Module *M) {
   MutexGuard locked(lock);
   OwnedModules.addModule(M);
+  if (LazyFunctionCompilation)
+    splitModuleIntoFunctions(M);
 }
 
 bool MCJIT::removeModule(Module *M) {
@@ -133,6 +150,190 @@ void MCJIT::setObjectCache(ObjectCache* NewCache) {
   ObjCache = NewCache;
 }
 
+void MCJIT::setLazyFunctionCompilation(bool Enabled) {
+  MutexGuard locked(lock);
+  if (!Enabled) {
+    LazyFunctionCompilation = false;
+    // Drop whatever is still waiting for the background compiler.
+    PrecompileQueue = std::priority_queue<QueuedFunction>();
+    return;
+  }
+  if (LazyFunctionCompilation)
+    return;
+  LazyFunctionCompilation = true;
+
+  // Split up the modules that haven't been compiled yet.
+  SmallVector<Module *, 4> Pending(OwnedModules.begin_added(),
+                                   OwnedModules.end_added());
+  for (unsigned i = 0, e = Pending.size(); i != e; ++i)
+    splitModuleIntoFunctions(Pending[i]);
+}
+
+void MCJIT::precompileFunction(Function *F, unsigned Hotness) {
+  MutexGuard locked(lock);
+  if (!LazyFunctionCompilation || ShuttingDown)
+    return;
+
+  PrecompileQueue.push(QueuedFunction(Hotness, F->getName()));
+  if (!BackgroundCompiler)
+    BackgroundCompiler.reset(new ThreadPool(1));
+  BackgroundCompiler->async([this] { compileNextQueuedFunction(); });
+}
+
+void MCJIT::compileNextQueuedFunction() {
+  MutexGuard locked(lock);
+  if (ShuttingDown || PrecompileQueue.empty())
+    return;
+
+  std::string Name = PrecompileQueue.top().second;
+  PrecompileQueue.pop();
+
+  // The function may have been compiled since it was queued. Code compiled
+  // here is only loaded; it's finalized along with whatever needs it first.
+  StringMap<Module *>::iterator I = LazyFunctionModules.find(Name);
+  if (I != LazyFunctionModules.end() &&
+      OwnedModules.hasModuleBeenAddedButNotLoaded(I->second))
+    generateCodeForModule(I->second);
+}
+
+namespace {
+// Declares the globals a function refers to in the module it's moved into.
+class GlobalDeclarer : public ValueMaterializer {
+  Module &Dst;
+
+public:
+  GlobalDeclarer(Module &Dst) : Dst(Dst) {}
+
+  Value *materializeValueFor(Value *V) override {
+    GlobalValue *GV = dyn_cast<GlobalValue>(V);
+    if (!GV)
+      return nullptr;
+
+    GlobalValue::LinkageTypes Linkage = GV->hasExternalWeakLinkage()
+                                            ? GlobalValue::ExternalWeakLinkage
+                                            : GlobalValue::ExternalLinkage;
+    Type *Ty = GV->getType()->getElementType();
+    if (FunctionType *FTy = dyn_cast<FunctionType>(Ty)) {
+      Function *Decl = Function::Create(FTy, Linkage, GV->getName(), &Dst);
+      if (Function *F = dyn_cast<Function>(GV)) {
+        Decl->setCallingConv(F->getCallingConv());
+        Decl->setAttributes(F->getAttributes());
+      }
+      return Decl;
+    }
+
+    GlobalVariable *Var = dyn_cast<GlobalVariable>(GV);
+    return new GlobalVariable(
+        Dst, Ty, Var && Var->isConstant(), Linkage, nullptr, GV->getName(),
+        nullptr,
+        Var ? Var->getThreadLocalMode() : GlobalValue::NotThreadLocal,
+        GV->getType()->getAddressSpace());
+  }
+};
+}
+
+// Give a local symbol a unique external name, so that functions split out of
+// its module can still refer to it from other objects.
+static void externalizeLocalSymbol(GlobalValue &GV, unsigned ModuleID) {
+  if (!GV.hasLocalLinkage())
+    return;
+  GV.setName(Twine(GV.hasName() ? GV.getName() : "__unnamed") + ".split" +
+             Twine(ModuleID));
+  GV.setLinkage(GlobalValue::ExternalLinkage);
+}
+
+static bool hasAddressTakenBlock(const Function &F) {
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    if (BB->hasAddressTaken())
+      return true;
+  return false;
+}
+
+void MCJIT::splitModuleIntoFunctions(Module *M) {
+  // Modules holding a single split out function stay as they are.
+  if (LazyModules.count(M))
+    return;
+
+  unsigned ModuleID = NumSplitModules++;
+  for (Module::global_iterator I = M->global_begin(), E = M->global_end();
+       I != E; ++I)
+    externalizeLocalSymbol(*I, ModuleID);
+  for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+    externalizeLocalSymbol(*I, ModuleID);
+  for (Module::alias_iterator I = M->alias_begin(), E = M->alias_end(); I != E;
+       ++I)
+    externalizeLocalSymbol(*I, ModuleID);
+
+  // An alias has to be emitted along with the function it aliases, so those
+  // stay behind, as do functions whose blocks have their address taken.
+  SmallPtrSet<const Value *, 8> Aliasees;
+  for (Module::alias_iterator I = M->alias_begin(), E = M->alias_end(); I != E;
+       ++I)
+    Aliasees.insert(I->getAliasee()->stripPointerCasts());
+
+  SmallVector<Function *, 16> Functions;
+  for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+    if (!I->isDeclaration() && !I->hasAvailableExternallyLinkage() &&
+        !Aliasees.count(I) && !hasAddressTakenBlock(*I))
+      Functions.push_back(I);
+
+  for (unsigned i = 0, e = Functions.size(); i != e; ++i) {
+    StringRef Name = Functions[i]->getName();
+    // With several definitions of a linkonce function, the first one wins.
+    if (LazyFunctionModules.count(Name))
+      continue;
+    Module *Piece = extractFunction(Functions[i]);
+    OwnedModules.addModule(Piece);
+    LazyModules.insert(Piece);
+    LazyFunctionModules[Name] = Piece;
+  }
+}
+
+Module *MCJIT::extractFunction(Function *F) {
+  Module *Src = F->getParent();
+  Module *Dst = new Module(F->getName(), Src->getContext());
+  Dst->setDataLayout(Src->getDataLayout());
+  Dst->setTargetTriple(Src->getTargetTriple());
+
+  Function *NewF = Function::Create(F->getFunctionType(), F->getLinkage(),
+                                    F->getName(), Dst);
+  NewF->copyAttributesFrom(F);
+
+  // Move the body over, leaving a declaration behind.
+  NewF->getBasicBlockList().splice(NewF->end(), F->getBasicBlockList());
+  for (Function::arg_iterator A = F->arg_begin(), NA = NewF->arg_begin(),
+                              AE = F->arg_end();
+       A != AE; ++A, ++NA) {
+    NA->takeName(A);
+    A->replaceAllUsesWith(NA);
+  }
+  F->deleteBody();
+
+  // Point the body at declarations in the new module. Debug info metadata is
+  // left alone; the new module has no compile unit, so none is emitted.
+  ValueToValueMapTy VMap;
+  VMap[F] = NewF;
+  GlobalDeclarer Declarer(*Dst);
+  RemapFlags Flags = RemapFlags(RF_NoModuleLevelChanges |
+                                RF_IgnoreMissingEntries);
+  for (Function::iterator BB = NewF->begin(), BE = NewF->end(); BB != BE; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+      RemapInstruction(I, VMap, Flags, nullptr, &Declarer);
+  if (NewF->hasPrefixData())
+    NewF->setPrefixData(cast<Constant>(MapValue(
+        NewF->getPrefixData(), VMap, RF_NoModuleLevelChanges, nullptr,
+        &Declarer)));
+
+  return Dst;
+}
+
+Function *MCJIT::findLazyFunctionBody(StringRef Name) {
+  StringMap<Module *>::iterator I = LazyFunctionModules.find(Name);
+  if (I == LazyFunctionModules.end())
+    return nullptr;
+  return I->second->getFunction(Name);
+}
+
 ObjectBufferStream* MCJIT::emitObject(Module *M) {
   MutexGuard locked(lock);
 
@@ -194,6 +395,11 @@ void MCJIT::generateCodeForModule(Module *M) {
 
   // If the cache did not contain a suitable object, compile the object
   if (!ObjectToLoad) {
+    DEBUG({
+      for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+        if (!I->isDeclaration())
+          dbgs() << "MCJIT: compiling function '" << I->getName() << "'\n";
+    });
     ObjectToLoad.reset(emitObject(M));
     assert(ObjectToLoad.get() && "Compilation did not produce an object.");
   }
@@ -236,6 +442,9 @@ void MCJIT::finalizeObject() {
                               E = OwnedModules.end_added();
        I != E; ++I) {
     Module *M = *I;
+    // Split out functions are compiled when something refers to them.
+    if (LazyFunctionCompilation && LazyModules.count(M))
+      continue;
     generateCodeForModule(M);
   }
 
@@ -270,6 +479,12 @@ Module *MCJIT::findModuleForSymbol(const std::string &Name,
                                    bool CheckFunctionsOnly) {
   MutexGuard locked(lock);
 
+  // Functions split out of their modules can be found directly.
+  StringMap<Module *>::iterator Lazy = LazyFunctionModules.find(Name);
+  if (Lazy != LazyFunctionModules.end() &&
+      OwnedModules.hasModuleBeenAddedButNotLoaded(Lazy->second))
+    return Lazy->second;
+
   // If it hasn't already been generated, see if it's in one of our modules.
   for (ModulePtrSet::iterator I = OwnedModules.begin_added(),
                               E = OwnedModules.end_added();
@@ -351,6 +566,11 @@ uint64_t MCJIT::getFunctionAddress(const std::string &Name) {
 void *MCJIT::getPointerToFunction(Function *F) {
   MutexGuard locked(lock);
 
+  // With lazy function compilation the body may have been split out.
+  if (F->isDeclaration())
+    if (Function *Body = findLazyFunctionBody(F->getName()))
+      F = Body;
+
   if (F->isDeclaration() || F->hasAvailableExternallyLinkage()) {
     bool AbortOnFailure = !F->hasExternalWeakLinkage();
     void *Addr = getPointerToNamedFunction(F->getName(), AbortOnFailure);
@@ -368,6 +588,11 @@ void *MCJIT::getPointerToFunction(Function *F) {
     // If this function doesn't belong to one of our modules, we're done.
     return nullptr;
 
+  // Nothing else will finalize a lazily compiled function before it is
+  // called.
+  if (LazyModules.count(M) && !OwnedModules.hasModuleBeenFinalized(M))
+    finalizeLoadedModules();
+
   // FIXME: Should the Dyld be retaining module information? Probably not.
   //
   // This is the accessor for the target address, so make sure to check the
@@ -13,11 +13,14 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/ObjectImage.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/ThreadPool.h"
+#include <queue>
 
 namespace llvm {
 class MCJIT;
@@ -225,6 +228,31 @@ class MCJIT : public ExecutionEngine {
   // perform lookup of pre-compiled code to avoid re-compilation.
   ObjectCache *ObjCache;
 
+  // Lazy function compilation.  When enabled, each function definition of an
+  // added module is moved into a module of its own, which stays in the
+  // "added" state until something refers to the function.
+  bool LazyFunctionCompilation;
+
+  // The single function modules, keyed by the name of their function.
+  StringMap<Module *> LazyFunctionModules;
+  ModulePtrSet LazyModules;
+
+  // Number of modules split so far, used to give their local symbols unique
+  // names.
+  unsigned NumSplitModules;
+
+  // Functions queued by precompileFunction, hottest first, and the thread
+  // compiling them.
+  typedef std::pair<unsigned, std::string> QueuedFunction;
+  std::priority_queue<QueuedFunction> PrecompileQueue;
+  std::unique_ptr<ThreadPool> BackgroundCompiler;
+  bool ShuttingDown;
+
+  void splitModuleIntoFunctions(Module *M);
+  Module *extractFunction(Function *F);
+  Function *findLazyFunctionBody(StringRef Name);
+  void compileNextQueuedFunction();
+
   Function *FindFunctionNamedInModulePtrSet(const char *FnName,
                                             ModulePtrSet::iterator I,
                                             ModulePtrSet::iterator E);
@@ -255,6 +283,9 @@ public:
     Dyld.setProcessAllSections(ProcessAllSections);
   }
 
+  void setLazyFunctionCompilation(bool Enabled) override;
+  void precompileFunction(Function *F, unsigned Hotness = 0) override;
+
   void generateCodeForModule(Module *M) override;
 
   /// finalizeObject - ensure the module is fully processed and is usable.
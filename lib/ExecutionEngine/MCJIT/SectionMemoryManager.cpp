@@ -15,6 +15,8 @@
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
 
 namespace llvm {
 
@@ -58,6 +60,7 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
       // Store cutted free memory block.
       MemGroup.FreeMem[i] = sys::MemoryBlock((void*)(Addr + Size),
                                              EndOfBlock - Addr - Size);
+      MemGroup.PendingMem.push_back(sys::MemoryBlock((void*)Addr, Size));
       return (uint8_t*)Addr;
     }
   }
@@ -66,16 +69,23 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // Note that all sections get allocated as read-write.  The permissions will
   // be updated later based on memory group.
   //
-  // FIXME: It would be useful to define a default allocation size (or add
-  // it as a constructor parameter) to minimize the number of allocations.
+  // Mapping a whole slab at once keeps the number of mappings (and, with huge
+  // pages, iTLB entries) down when many small objects are loaded.
   //
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
+  uintptr_t MapSize = std::max(RequiredSize, SlabSize);
+  unsigned Flags = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+  if (UseHugePages && &MemGroup == &CodeMem) {
+    const uintptr_t HugePageSize = 2 * 1024 * 1024;
+    MapSize = RoundUpToAlignment(MapSize, HugePageSize);
+    Flags |= sys::Memory::MF_HUGE_PAGE_HINT;
+  }
+
   std::error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(MapSize,
                                                           &MemGroup.Near,
-                                                          sys::Memory::MF_READ |
-                                                            sys::Memory::MF_WRITE,
+                                                          Flags,
                                                           ec);
   if (ec) {
     // FIXME: Add error propagation to the interface.
@@ -91,10 +101,11 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
 
   // Align the address.
   Addr = (Addr + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
+  MemGroup.PendingMem.push_back(sys::MemoryBlock((void*)Addr, Size));
 
   // The allocateMappedMemory may allocate much more memory than we need. In
   // this case, we store the unused memory as a free memory block.
-  unsigned FreeSize = EndOfBlock-Addr-Size;
+  uintptr_t FreeSize = EndOfBlock-Addr-Size;
   if (FreeSize > 16)
     MemGroup.FreeMem.push_back(sys::MemoryBlock((void*)(Addr + Size), FreeSize));
 
@@ -107,9 +118,6 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
   // FIXME: Should in-progress permissions be reverted if an error occurs?
   std::error_code ec;
 
-  // Don't allow free memory blocks to be used after setting protection flags.
-  CodeMem.FreeMem.clear();
-
   // Make code memory executable.
   ec = applyMemoryGroupPermissions(CodeMem,
                                    sys::Memory::MF_READ | sys::Memory::MF_EXEC);
@@ -120,9 +128,6 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
     return true;
   }
 
-  // Don't allow free memory blocks to be used after setting protection flags.
-  RODataMem.FreeMem.clear();
-
   // Make read-only data memory read-only.
   ec = applyMemoryGroupPermissions(RODataMem,
                                    sys::Memory::MF_READ | sys::Memory::MF_EXEC);
@@ -134,35 +139,94 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
   }
 
   // Read-write data memory already has the correct permissions
+  RWDataMem.PendingMem.clear();
 
   // Some platforms with separate data cache and instruction cache require
   // explicit cache flush, otherwise JIT code manipulations (like resolved
   // relocations) will get to the data cache but not to the instruction cache.
   invalidateInstructionCache();
 
+  CodeMem.PendingMem.clear();
+  RODataMem.PendingMem.clear();
   return false;
 }
 
+static bool compareBlockAddresses(const sys::MemoryBlock &A,
+                                  const sys::MemoryBlock &B) {
+  return A.base() < B.base();
+}
+
 std::error_code
 SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                   unsigned Permissions) {
+  SmallVectorImpl<sys::MemoryBlock> &Pending = MemGroup.PendingMem;
+  if (Pending.empty())
+    return std::error_code();
+
+  // Round the memory handed out since the last finalization to whole pages
+  // and merge neighbouring blocks, so that each run of pages is protected
+  // with a single call.
+  static const uintptr_t PageSize = sys::process::get_self()->page_size();
+  std::sort(Pending.begin(), Pending.end(), compareBlockAddresses);
+  SmallVector<sys::MemoryBlock, 16> Pages;
+  for (unsigned i = 0, e = Pending.size(); i != e; ++i) {
+    uintptr_t Start = (uintptr_t)Pending[i].base() & ~(PageSize - 1);
+    uintptr_t End = RoundUpToAlignment((uintptr_t)Pending[i].base() +
+                                       Pending[i].size(), PageSize);
+    if (!Pages.empty()) {
+      sys::MemoryBlock &Last = Pages.back();
+      uintptr_t LastEnd = (uintptr_t)Last.base() + Last.size();
+      if (Start <= LastEnd) {
+        Last = sys::MemoryBlock(Last.base(),
+                                std::max(End, LastEnd) - (uintptr_t)Last.base());
+        continue;
+      }
+    }
+    Pages.push_back(sys::MemoryBlock((void*)Start, End - Start));
+  }
 
-  for (int i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
-    std::error_code ec;
-    ec =
-        sys::Memory::protectMappedMemory(MemGroup.AllocatedMem[i], Permissions);
+  for (unsigned i = 0, e = Pages.size(); i != e; ++i) {
+    std::error_code ec =
+        sys::Memory::protectMappedMemory(Pages[i], Permissions);
     if (ec) {
       return ec;
     }
   }
 
+  // Free memory which shares a page with memory that was just protected can
+  // no longer be written.  Keep only the part beyond the protected pages, so
+  // the rest of the slab can still be used by later objects.
+  SmallVectorImpl<sys::MemoryBlock> &FreeMem = MemGroup.FreeMem;
+  for (unsigned i = 0; i != FreeMem.size(); ) {
+    uintptr_t FreeStart = (uintptr_t)FreeMem[i].base();
+    uintptr_t FreeEnd = FreeStart + FreeMem[i].size();
+    for (unsigned j = 0, e = Pages.size(); j != e; ++j) {
+      uintptr_t PageStart = (uintptr_t)Pages[j].base();
+      uintptr_t PageEnd = PageStart + Pages[j].size();
+      if (PageEnd <= FreeStart || FreeEnd <= PageStart)
+        continue;
+      if (PageStart <= FreeStart)
+        FreeStart = std::min(PageEnd, FreeEnd);
+      else
+        FreeEnd = PageStart;
+    }
+    if (FreeStart == FreeEnd) {
+      FreeMem.erase(FreeMem.begin() + i);
+      continue;
+    }
+    FreeMem[i] = sys::MemoryBlock((void*)FreeStart, FreeEnd - FreeStart);
+    ++i;
+  }
+
+  // Keep the protected pages around for invalidateInstructionCache.
+  Pending.swap(Pages);
   return std::error_code();
 }
 
 void SectionMemoryManager::invalidateInstructionCache() {
-  for (int i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::InvalidateInstructionCache(CodeMem.AllocatedMem[i].base(),
-                                            CodeMem.AllocatedMem[i].size());
+  for (int i = 0, e = CodeMem.PendingMem.size(); i != e; ++i)
+    sys::Memory::InvalidateInstructionCache(CodeMem.PendingMem[i].base(),
+                                            CodeMem.PendingMem[i].size());
 }
 
 SectionMemoryManager::~SectionMemoryManager() {
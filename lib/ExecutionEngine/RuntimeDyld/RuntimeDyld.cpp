@@ -18,14 +18,21 @@
 #include "RuntimeDyldImpl.h"
 #include "RuntimeDyldMachO.h"
 #include "llvm/Object/ELF.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/ThreadPool.h"
 
 using namespace llvm;
 using namespace llvm::object;
 
 #define DEBUG_TYPE "dyld"
 
+static cl::opt<unsigned> ParallelRelocationThreshold(
+    "rtdyld-parallel-relocation-threshold", cl::Hidden, cl::init(16384),
+    cl::desc("Resolve relocations on multiple threads once at least this "
+             "many are pending (0 disables)"));
+
 // Empty out-of-line virtual destructor as the key function.
 RuntimeDyldImpl::~RuntimeDyldImpl() {}
 
@@ -47,6 +54,24 @@ void RuntimeDyldImpl::resolveRelocations() {
   // First, resolve relocations associated with external symbols.
   resolveExternalSymbols();
 
+  unsigned NumRelocations = 0;
+  for (DenseMap<unsigned, RelocationList>::iterator I = Relocations.begin(),
+                                                    E = Relocations.end();
+       I != E; ++I)
+    NumRelocations += I->second.size();
+
+  bool Parallel = ParallelRelocationThreshold &&
+                  NumRelocations >= ParallelRelocationThreshold &&
+                  ThreadPool::getThreadCount() > 1;
+#ifndef NDEBUG
+  // Keep the debug output readable.
+  Parallel = Parallel && !DebugFlag;
+#endif
+  if (Parallel) {
+    resolveRelocationsInParallel();
+    return;
+  }
+
   // Just iterate over the sections we have and resolve all the relocations
   // in them. Gross overkill, but it gets the job done.
   for (int i = 0, e = Sections.size(); i != e; ++i) {
@@ -61,6 +86,45 @@ void RuntimeDyldImpl::resolveRelocations() {
   }
 }
 
+void RuntimeDyldImpl::resolveRelocationsInParallel() {
+  // Group the relocations by the section they patch, so that no two threads
+  // ever write to the same section.  Within a section the relocations keep
+  // the order the serial loop would apply them in, which matters for targets
+  // that apply several relocations to the same location.
+  typedef std::pair<const RelocationEntry *, uint64_t> PendingRelocation;
+  std::vector<std::vector<PendingRelocation> > ByTarget(Sections.size());
+  for (unsigned i = 0, e = Sections.size(); i != e; ++i) {
+    DenseMap<unsigned, RelocationList>::const_iterator I = Relocations.find(i);
+    if (I == Relocations.end())
+      continue;
+    uint64_t Addr = Sections[i].LoadAddress;
+    const RelocationList &Relocs = I->second;
+    for (unsigned j = 0, je = Relocs.size(); j != je; ++j) {
+      const RelocationEntry &RE = Relocs[j];
+      // Ignore relocations for sections that were not loaded
+      if (Sections[RE.SectionID].Address == nullptr)
+        continue;
+      ByTarget[RE.SectionID].push_back(PendingRelocation(&RE, Addr));
+    }
+  }
+
+  {
+    ThreadPool Pool;
+    for (unsigned i = 0, e = ByTarget.size(); i != e; ++i) {
+      if (ByTarget[i].empty())
+        continue;
+      const std::vector<PendingRelocation> &Work = ByTarget[i];
+      Pool.async([this, &Work] {
+        for (unsigned j = 0, je = Work.size(); j != je; ++j)
+          resolveRelocation(*Work[j].first, Work[j].second);
+      });
+    }
+    Pool.wait();
+  }
+
+  Relocations.clear();
+}
+
 void RuntimeDyldImpl::mapSectionAddress(const void *LocalAddress,
                                         uint64_t TargetAddress) {
   MutexGuard locked(lock);
@@ -639,15 +703,23 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
       SymbolTableMap::const_iterator Loc = GlobalSymbolTable.find(Name);
       if (Loc == GlobalSymbolTable.end()) {
         // This is an external symbol, try to get its address from
-        // MemoryManager.
-        Addr = MemMgr->getSymbolAddress(Name.data());
-        // The call to getSymbolAddress may have caused additional modules to
-        // be loaded, which may have added new entries to the
-        // ExternalSymbolRelocations map.  Consquently, we need to update our
-        // iterator.  This is also why retrieval of the relocation list
-        // associated with this symbol is deferred until below this point.
-        // New entries may have been added to the relocation list.
-        i = ExternalSymbolRelocations.find(Name);
+        // MemoryManager, unless an earlier load already did.
+        StringMap<uint64_t>::const_iterator Cached =
+            ExternalSymbolAddresses.find(Name);
+        if (Cached != ExternalSymbolAddresses.end()) {
+          Addr = Cached->second;
+        } else {
+          Addr = MemMgr->getSymbolAddress(Name.data());
+          // The call to getSymbolAddress may have caused additional modules
+          // to be loaded, which may have added new entries to the
+          // ExternalSymbolRelocations map.  Consquently, we need to update our
+          // iterator.  This is also why retrieval of the relocation list
+          // associated with this symbol is deferred until below this point.
+          // New entries may have been added to the relocation list.
+          i = ExternalSymbolRelocations.find(Name);
+          if (Addr)
+            ExternalSymbolAddresses[Name] = Addr;
+        }
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
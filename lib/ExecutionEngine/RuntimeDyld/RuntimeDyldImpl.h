@@ -201,6 +201,13 @@ protected:
   // modules.  This map is indexed by symbol name.
   StringMap<RelocationList> ExternalSymbolRelocations;
 
+  // Addresses the memory manager returned for external symbols.  Objects
+  // loaded one after another tend to refer to the same runtime functions, and
+  // asking the memory manager can be expensive, so each name is looked up
+  // once.  Symbols later defined by a loaded object still take precedence, as
+  // GlobalSymbolTable is consulted first.
+  StringMap<uint64_t> ExternalSymbolAddresses;
+
   typedef std::map<RelocationValueRef, uintptr_t> StubMap;
 
   Triple::ArchType Arch;
@@ -324,6 +331,10 @@ protected:
   /// \brief Resolve relocations to external symbols.
   void resolveExternalSymbols();
 
+  /// \brief Resolve all relocations in the Relocations map on a thread pool,
+  /// with one task per section being written.
+  void resolveRelocationsInParallel();
+
   /// \brief Update GOT entries for external symbols.
   // The base class does nothing.  ELF overrides this.
   virtual void updateGOTEntries(StringRef Name, uint64_t Addr) {}
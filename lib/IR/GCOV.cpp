@@ -135,6 +135,7 @@ bool GCOVFunction::readGCNO(GCOVBuffer &Buff, GCOV::GCOVVersion Version) {
   }
   uint32_t BlockCount;
   if (!Buff.readInt(BlockCount)) return false;
+  Blocks.reserve(BlockCount);
   for (uint32_t i = 0, e = BlockCount; i != e; ++i) {
     if (!Buff.readInt(Dummy)) return false; // Block flags;
     Blocks.push_back(make_unique<GCOVBlock>(*this, i));
@@ -348,9 +349,7 @@ void GCOVBlock::sortDstEdges() {
 /// collectLineCounts - Collect line counts. This must be used after
 /// reading .gcno and .gcda files.
 void GCOVBlock::collectLineCounts(FileInfo &FI) {
-  for (SmallVectorImpl<uint32_t>::iterator I = Lines.begin(),
-         E = Lines.end(); I != E; ++I)
-    FI.addBlockLine(Parent.getFilename(), *I, this);
+  FI.addBlockLines(Parent.getFilename(), Lines, this);
 }
 
 /// dump - Dump GCOVBlock content to dbgs() for debugging purposes.
@@ -523,16 +522,31 @@ FileInfo::openCoveragePath(StringRef CoveragePath) {
   return std::move(OS);
 }
 
+void FileInfo::writeReport(const CoverageReport &Report) {
+  std::unique_ptr<raw_ostream> OS = openCoveragePath(Report.first);
+  *OS << Report.second;
+}
+
 /// print -  Print source files with collected line count information.
 void FileInfo::print(StringRef MainFilename, StringRef GCNOFile,
                      StringRef GCDAFile) {
+  print(outs(), MainFilename, GCNOFile, GCDAFile);
+}
+
+void FileInfo::print(raw_ostream &InfoOS, StringRef MainFilename,
+                     StringRef GCNOFile, StringRef GCDAFile) {
   for (StringMap<LineData>::const_iterator I = LineInfo.begin(),
          E = LineInfo.end(); I != E; ++I) {
     StringRef Filename = I->first();
     auto AllLines = LineConsumer(Filename);
 
     std::string CoveragePath = getCoveragePath(Filename, MainFilename);
-    std::unique_ptr<raw_ostream> S = openCoveragePath(CoveragePath);
+    std::string Report;
+    std::unique_ptr<raw_ostream> S;
+    if (KeepReports && !Options.NoOutput)
+      S = llvm::make_unique<raw_string_ostream>(Report);
+    else
+      S = openCoveragePath(CoveragePath);
     raw_ostream &OS = *S;
 
     OS << "        -:    0:Source:" << Filename << "\n";
@@ -545,19 +559,16 @@ void FileInfo::print(StringRef MainFilename, StringRef GCNOFile,
     GCOVCoverage FileCoverage(Filename);
     for (uint32_t LineIndex = 0;
          LineIndex < Line.LastLine || !AllLines.empty(); ++LineIndex) {
-      if (Options.BranchInfo) {
-        FunctionLines::const_iterator FuncsIt = Line.Functions.find(LineIndex);
-        if (FuncsIt != Line.Functions.end())
-          printFunctionSummary(OS, FuncsIt->second);
-      }
+      if (Options.BranchInfo && LineIndex < Line.Functions.size() &&
+          !Line.Functions[LineIndex].empty())
+        printFunctionSummary(OS, Line.Functions[LineIndex]);
 
-      BlockLines::const_iterator BlocksIt = Line.Blocks.find(LineIndex);
-      if (BlocksIt == Line.Blocks.end()) {
+      if (LineIndex >= Line.Blocks.size() || Line.Blocks[LineIndex].empty()) {
         // No basic blocks are on this line. Not an executable line of code.
         OS << "        -:";
         AllLines.printNext(OS, LineIndex + 1);
       } else {
-        const BlockVector &Blocks = BlocksIt->second;
+        const BlockVector &Blocks = Line.Blocks[LineIndex];
 
         // Add up the block counts to form line counts.
         DenseMap<const GCOVFunction *, bool> LineExecs;
@@ -640,13 +651,16 @@ void FileInfo::print(StringRef MainFilename, StringRef GCNOFile,
         }
       }
     }
+    S.reset();
+    if (KeepReports && !Options.NoOutput)
+      Reports.push_back(CoverageReport(CoveragePath, std::move(Report)));
     FileCoverages.push_back(std::make_pair(CoveragePath, FileCoverage));
   }
 
   // FIXME: There is no way to detect calls given current instrumentation.
   if (Options.FuncCoverage)
-    printFuncCoverage();
-  printFileCoverage();
+    printFuncCoverage(InfoOS);
+  printFileCoverage(InfoOS);
   return;
 }
 
@@ -721,46 +735,47 @@ void FileInfo::printUncondBranchInfo(raw_ostream &OS, uint32_t &EdgeNo,
 
 // printCoverage - Print generic coverage info used by both printFuncCoverage
 // and printFileCoverage.
-void FileInfo::printCoverage(const GCOVCoverage &Coverage) const {
-  outs() << format("Lines executed:%.2f%% of %u\n",
-                   double(Coverage.LinesExec)*100/Coverage.LogicalLines,
-                   Coverage.LogicalLines);
+void FileInfo::printCoverage(raw_ostream &OS,
+                             const GCOVCoverage &Coverage) const {
+  OS << format("Lines executed:%.2f%% of %u\n",
+               double(Coverage.LinesExec)*100/Coverage.LogicalLines,
+               Coverage.LogicalLines);
   if (Options.BranchInfo) {
     if (Coverage.Branches) {
-      outs() << format("Branches executed:%.2f%% of %u\n",
-                       double(Coverage.BranchesExec)*100/Coverage.Branches,
-                       Coverage.Branches);
-      outs() << format("Taken at least once:%.2f%% of %u\n",
-                       double(Coverage.BranchesTaken)*100/Coverage.Branches,
-                       Coverage.Branches);
+      OS << format("Branches executed:%.2f%% of %u\n",
+                   double(Coverage.BranchesExec)*100/Coverage.Branches,
+                   Coverage.Branches);
+      OS << format("Taken at least once:%.2f%% of %u\n",
+                   double(Coverage.BranchesTaken)*100/Coverage.Branches,
+                   Coverage.Branches);
     } else {
-      outs() << "No branches\n";
+      OS << "No branches\n";
     }
-    outs() << "No calls\n"; // to be consistent with gcov
+    OS << "No calls\n"; // to be consistent with gcov
   }
 }
 
 // printFuncCoverage - Print per-function coverage info.
-void FileInfo::printFuncCoverage() const {
+void FileInfo::printFuncCoverage(raw_ostream &OS) const {
   for (FuncCoverageMap::const_iterator I = FuncCoverages.begin(),
                                        E = FuncCoverages.end(); I != E; ++I) {
     const GCOVCoverage &Coverage = I->second;
-    outs() << "Function '" << Coverage.Name << "'\n";
-    printCoverage(Coverage);
-    outs() << "\n";
+    OS << "Function '" << Coverage.Name << "'\n";
+    printCoverage(OS, Coverage);
+    OS << "\n";
   }
 }
 
 // printFileCoverage - Print per-file coverage info.
-void FileInfo::printFileCoverage() const {
+void FileInfo::printFileCoverage(raw_ostream &OS) const {
   for (FileCoverageList::const_iterator I = FileCoverages.begin(),
                                         E = FileCoverages.end(); I != E; ++I) {
     const std::string &Filename = I->first;
     const GCOVCoverage &Coverage = I->second;
-    outs() << "File '" << Coverage.Name << "'\n";
-    printCoverage(Coverage);
+    OS << "File '" << Coverage.Name << "'\n";
+    printCoverage(OS, Coverage);
     if (!Options.NoOutput)
-      outs() << Coverage.Name << ":creating '" << Filename << "'\n";
-    outs() << "\n";
+      OS << Coverage.Name << ":creating '" << Filename << "'\n";
+    OS << "\n";
   }
 }
@@ -46,10 +46,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/Verifier.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/CallSite.h"
@@ -68,17 +71,31 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdarg>
 using namespace llvm;
 
+#define DEBUG_TYPE "verify"
+
+STATISTIC(NumFunctionsVerified, "Number of functions verified");
+STATISTIC(NumFunctionsSkipped,
+          "Number of functions not re-verified because they were unchanged");
+
 static cl::opt<bool> VerifyDebugInfo("verify-debug-info", cl::init(false));
 
+static cl::opt<bool> VerifySkipUnchanged(
+    "verify-skip-unchanged", cl::init(false),
+    cl::desc("Don't let the verifier pass re-verify functions which have not "
+             "changed since they last passed it"));
+
 namespace {
 struct VerifierSupport {
   raw_ostream &OS;
@@ -2581,6 +2598,144 @@ bool llvm::verifyModule(const Module &M, raw_ostream *OS) {
   return !V.verify(M) || !DIV.verify(M) || Broken;
 }
 
+/// Hash the fields of \p I which aren't operands but are checked by the
+/// verifier.
+static hash_code hashInstructionFields(const Instruction &I) {
+  if (const AllocaInst *AI = dyn_cast<AllocaInst>(&I))
+    return hash_combine(AI->getAlignment(), AI->getAllocatedType());
+  if (const LoadInst *LI = dyn_cast<LoadInst>(&I))
+    return hash_combine(LI->isVolatile(), LI->getAlignment(),
+                        unsigned(LI->getOrdering()),
+                        unsigned(LI->getSynchScope()));
+  if (const StoreInst *SI = dyn_cast<StoreInst>(&I))
+    return hash_combine(SI->isVolatile(), SI->getAlignment(),
+                        unsigned(SI->getOrdering()),
+                        unsigned(SI->getSynchScope()));
+  if (const CmpInst *CI = dyn_cast<CmpInst>(&I))
+    return hash_value(unsigned(CI->getPredicate()));
+  if (const CallInst *CI = dyn_cast<CallInst>(&I))
+    return hash_combine(CI->getCallingConv(), unsigned(CI->getTailCallKind()),
+                        CI->getAttributes().getRawPointer());
+  if (const InvokeInst *II = dyn_cast<InvokeInst>(&I))
+    return hash_combine(II->getCallingConv(),
+                        II->getAttributes().getRawPointer());
+  if (const AtomicCmpXchgInst *CXI = dyn_cast<AtomicCmpXchgInst>(&I))
+    return hash_combine(CXI->isVolatile(),
+                        unsigned(CXI->getSuccessOrdering()),
+                        unsigned(CXI->getFailureOrdering()),
+                        unsigned(CXI->getSynchScope()));
+  if (const AtomicRMWInst *RMWI = dyn_cast<AtomicRMWInst>(&I))
+    return hash_combine(unsigned(RMWI->getOperation()), RMWI->isVolatile(),
+                        unsigned(RMWI->getOrdering()),
+                        unsigned(RMWI->getSynchScope()));
+  if (const FenceInst *FI = dyn_cast<FenceInst>(&I))
+    return hash_combine(unsigned(FI->getOrdering()),
+                        unsigned(FI->getSynchScope()));
+  if (const LandingPadInst *LPI = dyn_cast<LandingPadInst>(&I))
+    return hash_value(LPI->isCleanup());
+  if (const ExtractValueInst *EVI = dyn_cast<ExtractValueInst>(&I))
+    return hash_combine_range(EVI->idx_begin(), EVI->idx_end());
+  if (const InsertValueInst *IVI = dyn_cast<InsertValueInst>(&I))
+    return hash_combine_range(IVI->idx_begin(), IVI->idx_end());
+  if (const PHINode *PN = dyn_cast<PHINode>(&I))
+    return hash_combine_range(PN->block_begin(), PN->block_end());
+  return hash_value(0u);
+}
+
+/// Fingerprint everything about \p F that verifying it looks at, so that a
+/// function which already passed the verifier can be recognized as unchanged.
+///
+/// This runs on every function for every verifier pass, so it has to be much
+/// cheaper than verifying: the fields are gathered into a buffer and hashed
+/// in one go rather than combined one at a time.
+static hash_code fingerprintFunction(const Function &F) {
+  SmallVector<uintptr_t, 512> Fields;
+  Fields.push_back(reinterpret_cast<uintptr_t>(&F));
+  Fields.push_back(reinterpret_cast<uintptr_t>(F.getParent()));
+  Fields.push_back(reinterpret_cast<uintptr_t>(F.getType()));
+  Fields.push_back(hash_value(F.getName()));
+  Fields.push_back(F.getLinkage() | F.getVisibility() << 8 |
+                   F.getDLLStorageClass() << 16 | F.hasUnnamedAddr() << 24 |
+                   F.isMaterializable() << 25 | F.hasGC() << 26);
+  Fields.push_back(F.getCallingConv() | uint64_t(F.getAlignment()) << 32);
+  Fields.push_back(
+      reinterpret_cast<uintptr_t>(F.getAttributes().getRawPointer()));
+  Fields.push_back(reinterpret_cast<uintptr_t>(
+      F.hasPrefixData() ? F.getPrefixData() : nullptr));
+  if (F.hasGC())
+    Fields.push_back(hash_value(StringRef(F.getGC())));
+  if (F.hasSection())
+    Fields.push_back(hash_value(StringRef(F.getSection())));
+
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+    Fields.push_back(reinterpret_cast<uintptr_t>(&*BB));
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      Fields.push_back(reinterpret_cast<uintptr_t>(&*I));
+      Fields.push_back(reinterpret_cast<uintptr_t>(I->getType()));
+      Fields.push_back(I->getOpcode() | I->getRawSubclassOptionalData() << 8);
+      // Plain arithmetic and casts have no fields beyond their operands.
+      if (!isa<BinaryOperator>(I) && !isa<CastInst>(I))
+        Fields.push_back(hashInstructionFields(*I));
+      // Operands local to the function are covered by the walk itself: an
+      // instruction or block can't be moved without changing the lists
+      // recorded here.
+      for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+           OI != OE; ++OI)
+        Fields.push_back(reinterpret_cast<uintptr_t>(OI->get()));
+      if (!I->hasMetadata())
+        continue;
+      I->getAllMetadata(MDs);
+      for (unsigned i = 0, e = MDs.size(); i != e; ++i) {
+        Fields.push_back(MDs[i].first);
+        Fields.push_back(reinterpret_cast<uintptr_t>(MDs[i].second));
+      }
+    }
+    // Fold long functions into the hash as we go to keep the buffer small.
+    if (Fields.size() > 4096) {
+      hash_code Hash = hash_combine_range(Fields.begin(), Fields.end());
+      Fields.clear();
+      Fields.push_back(Hash);
+    }
+  }
+  return hash_combine_range(Fields.begin(), Fields.end());
+}
+
+namespace {
+struct VerifiedFunctionCache;
+
+/// Drops a function's fingerprint when the function is deleted, so that the
+/// cache doesn't grow without bound or match a new function that happens to
+/// be allocated at the same address.
+class VerifiedFunctionVH : public CallbackVH {
+  VerifiedFunctionCache *Cache;
+  void deleted() override;
+
+public:
+  VerifiedFunctionVH(Value *V, VerifiedFunctionCache *Cache = nullptr)
+      : CallbackVH(V), Cache(Cache) {}
+};
+
+/// The fingerprints of the functions which last passed a verifier pass,
+/// shared by all verifier passes so that those run between other passes
+/// (opt -verify-each) can skip the functions nothing has touched.
+struct VerifiedFunctionCache {
+  sys::SmartMutex<true> Lock;
+  DenseMap<VerifiedFunctionVH, hash_code, DenseMapInfo<Value *> > Fingerprints;
+};
+}
+
+void VerifiedFunctionVH::deleted() {
+  sys::SmartScopedLock<true> Guard(Cache->Lock);
+  auto I = Cache->Fingerprints.find_as(getValPtr());
+  if (I != Cache->Fingerprints.end())
+    Cache->Fingerprints.erase(I);
+  // this now dangles!
+}
+
+static ManagedStatic<VerifiedFunctionCache> VerifiedFunctions;
+
 namespace {
 struct VerifierLegacyPass : public FunctionPass {
   static char ID;
@@ -2597,9 +2752,34 @@ struct VerifierLegacyPass : public FunctionPass {
   }
 
   bool runOnFunction(Function &F) override {
-    if (!V.verify(F) && FatalErrors)
-      report_fatal_error("Broken function found, compilation aborted!");
+    hash_code Fingerprint;
+    if (VerifySkipUnchanged) {
+      Fingerprint = fingerprintFunction(F);
+      sys::SmartScopedLock<true> Guard(VerifiedFunctions->Lock);
+      auto I =
+          VerifiedFunctions->Fingerprints.find_as(static_cast<Value *>(&F));
+      if (I != VerifiedFunctions->Fingerprints.end() &&
+          I->second == Fingerprint) {
+        DEBUG(dbgs() << "Skipping unchanged function '" << F.getName()
+                     << "'\n");
+        ++NumFunctionsSkipped;
+        return false;
+      }
+    }
 
+    DEBUG(dbgs() << "Verifying function '" << F.getName() << "'\n");
+    ++NumFunctionsVerified;
+    if (!V.verify(F)) {
+      if (FatalErrors)
+        report_fatal_error("Broken function found, compilation aborted!");
+      return false;
+    }
+
+    if (VerifySkipUnchanged) {
+      sys::SmartScopedLock<true> Guard(VerifiedFunctions->Lock);
+      VerifiedFunctions->Fingerprints[VerifiedFunctionVH(
+          &F, &*VerifiedFunctions)] = Fingerprint;
+    }
     return false;
   }
 
@@ -52,6 +52,9 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SkippedRelaxationChecks,
+          "Number of relaxation checks skipped because nothing the fragment "
+          "depends on changed size");
 }
 }
 
@@ -864,7 +867,8 @@ void MCAssembler::Finish() {
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout))
+  std::vector<RelaxationWorklist> Worklists(Layout.getSectionOrder().size());
+  while (layoutOnce(Layout, Worklists))
     continue;
 
   DEBUG_WITH_TYPE("mc-dump", {
@@ -1022,41 +1026,196 @@ bool MCAssembler::relaxDwarfCallFrameFragment(MCAsmLayout &Layout,
   return OldSize != Data.size();
 }
 
-bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
-  // Holds the first fragment which needed relaxing during this layout. It will
-  // remain NULL if none were relaxed.
-  // When a fragment is relaxed, all the fragments following it should get
-  // invalidated because their offset is going to change.
-  MCFragment *FirstRelaxedFragment = nullptr;
+/// A fragment which may change size during relaxation. Whether it has to is
+/// decided by expressions involving the offsets of the fragments in
+/// [First, Last], so it only needs to be checked again once one of those
+/// changed size. Unbounded entries depend on something outside the section,
+/// and are checked on every pass.
+struct MCAssembler::RelaxationWorklist {
+  struct Entry {
+    MCFragment *F;
+    unsigned First, Last;
+    bool Unbounded;
+  };
+
+  /// The fragments to check, in layout order.
+  std::vector<Entry> Entries;
+
+  /// The layout orders of the fragments which changed size during the last
+  /// pass over the section, in increasing order.
+  std::vector<unsigned> Changed;
+
+  /// Set until the first pass over the section, which checks every entry.
+  bool CheckAll;
+
+  RelaxationWorklist() : CheckAll(true) {}
+
+  bool needsCheck(const Entry &E) const {
+    if (CheckAll || E.Unbounded)
+      return true;
+    std::vector<unsigned>::const_iterator I =
+      std::lower_bound(Changed.begin(), Changed.end(), E.First);
+    return I != Changed.end() && *I <= E.Last;
+  }
+};
+
+/// Extend [First, Last] to cover the fragments of \p SD defining the symbols
+/// referenced by \p Expr. Return false if the value of \p Expr may depend on
+/// anything else.
+static bool addExprDependencies(const MCAssembler &Asm, const MCExpr &Expr,
+                                const MCSectionData &SD, unsigned &First,
+                                unsigned &Last) {
+  switch (Expr.getKind()) {
+  case MCExpr::Constant:
+    return true;
+  case MCExpr::SymbolRef: {
+    const MCSymbol &Sym = cast<MCSymbolRefExpr>(Expr).getSymbol();
+    if (Sym.isVariable() || !Sym.isInSection() ||
+        &Sym.getSection() != &SD.getSection())
+      return false;
+    const MCFragment *F = Asm.getSymbolData(Sym).getFragment();
+    if (!F || F->getParent() != &SD)
+      return false;
+    First = std::min(First, F->getLayoutOrder());
+    Last = std::max(Last, F->getLayoutOrder());
+    return true;
+  }
+  case MCExpr::Unary:
+    return addExprDependencies(Asm, *cast<MCUnaryExpr>(Expr).getSubExpr(), SD,
+                               First, Last);
+  case MCExpr::Binary: {
+    const MCBinaryExpr &BE = cast<MCBinaryExpr>(Expr);
+    return addExprDependencies(Asm, *BE.getLHS(), SD, First, Last) &&
+           addExprDependencies(Asm, *BE.getRHS(), SD, First, Last);
+  }
+  case MCExpr::Target:
+    return false;
+  }
+  llvm_unreachable("Invalid expression kind!");
+}
+
+void MCAssembler::initRelaxationWorklist(MCSectionData &SD,
+                                         RelaxationWorklist &Worklist) const {
+  // Alignment and org fragments change size when anything before them does.
+  // So does every fragment when bundling is enabled.
+  std::vector<unsigned> OffsetDependent;
+  for (MCSectionData::iterator I = SD.begin(), IE = SD.end(); I != IE; ++I)
+    if (isa<MCAlignFragment>(I) || isa<MCOrgFragment>(I))
+      OffsetDependent.push_back(I->getLayoutOrder());
 
-  // Attempt to relax all the fragments in the section.
   for (MCSectionData::iterator I = SD.begin(), IE = SD.end(); I != IE; ++I) {
-    // Check if this is a fragment that needs relaxation.
-    bool RelaxedFrag = false;
-    switch(I->getKind()) {
+    RelaxationWorklist::Entry E;
+    E.F = I;
+    E.First = E.Last = I->getLayoutOrder();
+    E.Unbounded = false;
+    bool FromStart = isBundlingEnabled();
+
+    switch (I->getKind()) {
     default:
+      continue;
+    case MCFragment::FT_Relaxable: {
+      MCRelaxableFragment &RF = *cast<MCRelaxableFragment>(I);
+      if (!getBackend().mayNeedRelaxation(RF.getInst()))
+        continue;
+      for (MCRelaxableFragment::const_fixup_iterator FI = RF.fixup_begin(),
+           FE = RF.fixup_end(); FI != FE; ++FI) {
+        // Resolved values are differences of offsets in this section, except
+        // for fixups which are not PC-relative or are relative to an aligned
+        // PC; be conservative about those.
+        unsigned Flags = getBackend().getFixupKindInfo(FI->getKind()).Flags;
+        if (!(Flags & MCFixupKindInfo::FKF_IsPCRel) ||
+            (Flags & MCFixupKindInfo::FKF_IsAlignedDownTo32Bits))
+          FromStart = true;
+        if (!addExprDependencies(*this, *FI->getValue(), SD, E.First, E.Last))
+          E.Unbounded = true;
+      }
       break;
-    case MCFragment::FT_Relaxable:
-      assert(!getRelaxAll() &&
-             "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
-      break;
+    }
     case MCFragment::FT_Dwarf:
-      RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
+      E.Unbounded = !addExprDependencies(
+          *this, cast<MCDwarfLineAddrFragment>(I)->getAddrDelta(), SD, E.First,
+          E.Last);
       break;
     case MCFragment::FT_DwarfFrame:
-      RelaxedFrag =
-        relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
+      E.Unbounded = !addExprDependencies(
+          *this, cast<MCDwarfCallFrameFragment>(I)->getAddrDelta(), SD,
+          E.First, E.Last);
       break;
     case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
+      E.Unbounded = !addExprDependencies(
+          *this, cast<MCLEBFragment>(I)->getValue(), SD, E.First, E.Last);
       break;
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = I;
+
+    std::vector<unsigned>::iterator OI =
+      std::lower_bound(OffsetDependent.begin(), OffsetDependent.end(),
+                       E.First);
+    if (OI != OffsetDependent.end() && *OI <= E.Last)
+      FromStart = true;
+    if (FromStart)
+      E.First = 0;
+    Worklist.Entries.push_back(E);
+  }
+}
+
+bool MCAssembler::relaxFragment(MCAsmLayout &Layout, MCFragment &F) {
+  switch(F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable:
+    assert(!getRelaxAll() &&
+           "Did not expect a MCRelaxableFragment in RelaxAll mode");
+    return relaxInstruction(Layout, cast<MCRelaxableFragment>(F));
+  case MCFragment::FT_Dwarf:
+    return relaxDwarfLineAddr(Layout, cast<MCDwarfLineAddrFragment>(F));
+  case MCFragment::FT_DwarfFrame:
+    return relaxDwarfCallFrameFragment(Layout,
+                                       cast<MCDwarfCallFrameFragment>(F));
+  case MCFragment::FT_LEB:
+    return relaxLEB(Layout, cast<MCLEBFragment>(F));
+  }
+}
+
+bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                                    RelaxationWorklist &Worklist) {
+  if (Worklist.CheckAll)
+    initRelaxationWorklist(SD, Worklist);
+
+  // Holds the first fragment which needed relaxing during this layout. It will
+  // remain NULL if none were relaxed.
+  // When a fragment is relaxed, all the fragments following it should get
+  // invalidated because their offset is going to change.
+  MCFragment *FirstRelaxedFragment = nullptr;
+  std::vector<unsigned> Changed;
+
+  // Attempt to relax the fragments in the section whose dependencies changed
+  // size since they were last checked. Instructions which can't be relaxed
+  // any further are dropped from the worklist.
+  std::vector<RelaxationWorklist::Entry> &Entries = Worklist.Entries;
+  unsigned Kept = 0;
+  for (unsigned i = 0, e = Entries.size(); i != e; ++i) {
+    RelaxationWorklist::Entry &E = Entries[i];
+    if (!Worklist.needsCheck(E)) {
+      ++stats::SkippedRelaxationChecks;
+      Entries[Kept++] = E;
+      continue;
+    }
+
+    if (relaxFragment(Layout, *E.F)) {
+      Changed.push_back(E.F->getLayoutOrder());
+      if (!FirstRelaxedFragment)
+        FirstRelaxedFragment = E.F;
+    }
+
+    if (MCRelaxableFragment *RF = dyn_cast<MCRelaxableFragment>(E.F))
+      if (!getBackend().mayNeedRelaxation(RF->getInst()))
+        continue;
+    Entries[Kept++] = E;
   }
+  Entries.resize(Kept);
+  Worklist.Changed.swap(Changed);
+  Worklist.CheckAll = false;
+
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -1064,13 +1223,15 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
+bool MCAssembler::layoutOnce(MCAsmLayout &Layout,
+                             std::vector<RelaxationWorklist> &Worklists) {
   ++stats::RelaxationSteps;
 
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSectionData &SD = *it;
-    while (layoutSectionOnce(Layout, SD))
+    RelaxationWorklist &Worklist = Worklists[SD.getLayoutOrder()];
+    while (layoutSectionOnce(Layout, SD, Worklist))
       WasRelaxed = true;
   }
 
@@ -439,21 +439,29 @@ Archive::symbol_iterator Archive::symbol_end() const {
 }
 
 Archive::child_iterator Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-  Archive::child_iterator result;
-  
-  StringRef symname;
-  for (; bs != es; ++bs) {
-    if (bs->getName(symname))
-        return child_end();
-    if (symname == name) {
-      if (bs->getMember(result))
+  if (!SymbolIndex) {
+    std::unique_ptr<StringMap<uint32_t> > Index(new StringMap<uint32_t>());
+    uint32_t SymbolNum = 0;
+    StringRef symname;
+    for (symbol_iterator bs = symbol_begin(), es = symbol_end(); bs != es;
+         ++bs, ++SymbolNum) {
+      if (bs->getName(symname))
         return child_end();
-      return result;
+      // Keep the first entry, which is the one a linear search would find.
+      Index->GetOrCreateValue(symname, SymbolNum);
     }
+    SymbolIndex = std::move(Index);
   }
-  return child_end();
+
+  StringMap<uint32_t>::const_iterator I = SymbolIndex->find(name);
+  if (I == SymbolIndex->end())
+    return child_end();
+
+  // The string index is only needed to walk to the next symbol.
+  Archive::child_iterator result;
+  if (Symbol(this, I->getValue(), 0).getMember(result))
+    return child_end();
+  return result;
 }
 
 bool Archive::hasSymbolTable() const {
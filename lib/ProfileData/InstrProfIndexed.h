@@ -46,7 +46,9 @@ static inline uint64_t ComputeHash(HashT Type, StringRef K) {
 }
 
 const uint64_t Magic = 0x8169666f72706cff; // "\xfflprofi\x81"
-const uint64_t Version = 1;
+/// Version 2 pads each record so its counters are 8-byte aligned in the file.
+const uint64_t Version = 2;
+const uint64_t MinimumVersion = 1;
 const HashT HashType = HashT::MD5;
 }
 
@@ -14,16 +14,25 @@
 
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MathExtras.h"
 
 #include "InstrProfIndexed.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace llvm;
 
 static std::error_code
-setupMemoryBuffer(std::string Path, std::unique_ptr<MemoryBuffer> &Buffer) {
-  if (std::error_code EC = MemoryBuffer::getFileOrSTDIN(Path, Buffer))
+setupMemoryBuffer(std::string Path, std::unique_ptr<MemoryBuffer> &Buffer,
+                  bool RequiresNullTerminator = true) {
+  if (!RequiresNullTerminator) {
+    // Binary profiles don't need a terminator, which lets large ones be
+    // mapped rather than read into memory.
+    if (std::error_code EC = MemoryBuffer::getFile(Path, Buffer, -1, false))
+      return EC;
+  } else if (std::error_code EC = MemoryBuffer::getFileOrSTDIN(Path, Buffer))
     return EC;
 
   // Sanity check the file.
@@ -62,7 +71,7 @@ std::error_code IndexedInstrProfReader::create(
     std::string Path, std::unique_ptr<IndexedInstrProfReader> &Result) {
   // Set up the buffer to read.
   std::unique_ptr<MemoryBuffer> Buffer;
-  if (std::error_code EC = setupMemoryBuffer(Path, Buffer))
+  if (std::error_code EC = setupMemoryBuffer(Path, Buffer, false))
     return EC;
 
   // Create the reader.
@@ -280,6 +289,50 @@ InstrProfLookupTrait::ComputeHash(StringRef K) {
   return IndexedInstrProf::ComputeHash(HashType, K);
 }
 
+InstrProfRecord InstrProfLookupTrait::ReadData(StringRef K,
+                                               const unsigned char *D,
+                                               offset_type N) {
+  // Since version 2 the record is padded so that it starts at an aligned
+  // offset in the file.
+  if (FormatVersion >= 2) {
+    offset_type Padding = OffsetToAlignment(D - Base, sizeof(uint64_t));
+    if (Padding > N) {
+      CountBuffer.clear();
+      return InstrProfRecord("", 0, CountBuffer);
+    }
+    D += Padding;
+    N -= Padding;
+  }
+
+  if (N < 2 * sizeof(uint64_t) || N % sizeof(uint64_t)) {
+    // The data is corrupt, don't try to read it.
+    CountBuffer.clear();
+    return InstrProfRecord("", 0, CountBuffer);
+  }
+
+  using namespace support;
+
+  // The first stored value is the hash.
+  uint64_t Hash = endian::readNext<uint64_t, little, unaligned>(D);
+  // Each counter follows.
+  unsigned NumCounters = N / sizeof(uint64_t) - 1;
+
+  // If the counters are already in host order and aligned we can use them
+  // where they are.
+  if (sys::IsLittleEndianHost &&
+      (reinterpret_cast<uintptr_t>(D) & (alignOf<uint64_t>() - 1)) == 0)
+    return InstrProfRecord(
+        K, Hash, makeArrayRef(reinterpret_cast<const uint64_t *>(D),
+                              NumCounters));
+
+  CountBuffer.clear();
+  CountBuffer.reserve(NumCounters);
+  for (unsigned I = 0; I < NumCounters; ++I)
+    CountBuffer.push_back(endian::readNext<uint64_t, little, unaligned>(D));
+
+  return InstrProfRecord(K, Hash, CountBuffer);
+}
+
 bool IndexedInstrProfReader::hasFormat(const MemoryBuffer &DataBuffer) {
   if (DataBuffer.getBufferSize() < 8)
     return false;
@@ -305,7 +358,8 @@ std::error_code IndexedInstrProfReader::readHeader() {
 
   // Read the version.
   uint64_t Version = endian::readNext<uint64_t, little, unaligned>(Cur);
-  if (Version != IndexedInstrProf::Version)
+  if (Version < IndexedInstrProf::MinimumVersion ||
+      Version > IndexedInstrProf::Version)
     return error(instrprof_error::unsupported_version);
 
   // Read the maximal function count.
@@ -319,8 +373,9 @@ std::error_code IndexedInstrProfReader::readHeader() {
   uint64_t HashOffset = endian::readNext<uint64_t, little, unaligned>(Cur);
 
   // The rest of the file is an on disk hash table.
-  Index.reset(InstrProfReaderIndex::Create(Start + HashOffset, Cur, Start,
-                                           InstrProfLookupTrait(HashType)));
+  Index.reset(InstrProfReaderIndex::Create(
+      Start + HashOffset, Cur, Start,
+      InstrProfLookupTrait(HashType, Version, Start)));
   // Set up our iterator for readNextRecord.
   RecordIterator = Index->data_begin();
 
@@ -328,7 +383,7 @@ std::error_code IndexedInstrProfReader::readHeader() {
 }
 
 std::error_code IndexedInstrProfReader::getFunctionCounts(
-    StringRef FuncName, uint64_t &FuncHash, std::vector<uint64_t> &Counts) {
+    StringRef FuncName, uint64_t &FuncHash, ArrayRef<uint64_t> &Counts) {
   const auto &Iter = Index->find(FuncName);
   if (Iter == Index->end())
     return error(instrprof_error::unknown_function);
@@ -338,7 +393,32 @@ std::error_code IndexedInstrProfReader::getFunctionCounts(
   if (Record.Name.empty())
     return error(instrprof_error::malformed);
   FuncHash = Record.Hash;
-  Counts = Record.Counts;
+
+  // Counts that refer to the file can be handed out as is. Anything else is
+  // in the lookup trait's scratch buffer, so give it a stable home the first
+  // time the record is looked up.
+  const char *Data = reinterpret_cast<const char *>(Record.Counts.data());
+  if (Data >= DataBuffer->getBufferStart() &&
+      Data < DataBuffer->getBufferEnd()) {
+    Counts = Record.Counts;
+    return success();
+  }
+  ArrayRef<uint64_t> &Copied = CopiedCounts[Record.Name.data()];
+  if (Copied.empty() && !Record.Counts.empty()) {
+    uint64_t *Copy = CountsAllocator.Allocate<uint64_t>(Record.Counts.size());
+    std::copy(Record.Counts.begin(), Record.Counts.end(), Copy);
+    Copied = makeArrayRef(Copy, Record.Counts.size());
+  }
+  Counts = Copied;
+  return success();
+}
+
+std::error_code IndexedInstrProfReader::getFunctionCounts(
+    StringRef FuncName, uint64_t &FuncHash, std::vector<uint64_t> &Counts) {
+  ArrayRef<uint64_t> View;
+  if (std::error_code EC = getFunctionCounts(FuncName, FuncHash, View))
+    return EC;
+  Counts.assign(View.begin(), View.end());
   return success();
 }
 
@@ -15,6 +15,7 @@
 #include "llvm/ProfileData/InstrProfWriter.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/EndianStream.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/OnDiskHashTable.h"
 
 #include "InstrProfIndexed.h"
@@ -45,7 +46,11 @@ public:
     offset_type N = K.size();
     LE.write<offset_type>(N);
 
-    offset_type M = (1 + V->Counts.size()) * sizeof(uint64_t);
+    // The data is padded so that the hash and counters are naturally aligned
+    // in the file, which lets the reader use them in place.
+    uint64_t DataStart = Out.tell() + sizeof(offset_type) + N;
+    offset_type M = OffsetToAlignment(DataStart, sizeof(uint64_t)) +
+                    (1 + V->Counts.size()) * sizeof(uint64_t);
     LE.write<offset_type>(M);
 
     return std::make_pair(N, M);
@@ -59,6 +64,9 @@ public:
                        offset_type) {
     using namespace llvm::support;
     endian::Writer<little> LE(Out);
+    for (uint64_t Pad = OffsetToAlignment(Out.tell(), sizeof(uint64_t));
+         Pad; --Pad)
+      LE.write<uint8_t>(0);
     LE.write<uint64_t>(V->Hash);
     for (uint64_t I : V->Counts)
       LE.write<uint64_t>(I);
@@ -66,6 +74,24 @@ public:
 };
 }
 
+static std::error_code addCounts(InstrProfWriter::CounterData &Data,
+                                 uint64_t FunctionHash,
+                                 ArrayRef<uint64_t> Counters) {
+  // We can only add to existing functions if they match, so we check the hash
+  // and number of counters.
+  if (Data.Hash != FunctionHash)
+    return instrprof_error::hash_mismatch;
+  if (Data.Counts.size() != Counters.size())
+    return instrprof_error::count_mismatch;
+  // These match, add up the counters.
+  for (size_t I = 0, E = Counters.size(); I < E; ++I) {
+    if (Data.Counts[I] + Counters[I] < Data.Counts[I])
+      return instrprof_error::counter_overflow;
+    Data.Counts[I] += Counters[I];
+  }
+  return instrprof_error::success;
+}
+
 std::error_code
 InstrProfWriter::addFunctionCounts(StringRef FunctionName,
                                    uint64_t FunctionHash,
@@ -79,20 +105,41 @@ InstrProfWriter::addFunctionCounts(StringRef FunctionName,
     return instrprof_error::success;
   }
 
-  auto &Data = Where->getValue();
-  // We can only add to existing functions if they match, so we check the hash
-  // and number of counters.
-  if (Data.Hash != FunctionHash)
-    return instrprof_error::hash_mismatch;
-  if (Data.Counts.size() != Counters.size())
-    return instrprof_error::count_mismatch;
-  // These match, add up the counters.
-  for (size_t I = 0, E = Counters.size(); I < E; ++I) {
-    if (Data.Counts[I] + Counters[I] < Data.Counts[I])
-      return instrprof_error::counter_overflow;
-    Data.Counts[I] += Counters[I];
+  return addCounts(Where->getValue(), FunctionHash, Counters);
+}
+
+void InstrProfWriter::mergeRecordsFromWriter(
+    InstrProfWriter &Other,
+    function_ref<void(StringRef, std::error_code)> Warn) {
+  for (auto &I : Other.FunctionData) {
+    CounterData &OtherData = I.getValue();
+    auto Where = FunctionData.find(I.getKey());
+    if (Where == FunctionData.end()) {
+      // If this is the first time we've seen this function, take over the
+      // counts.
+      auto &Data = FunctionData[I.getKey()];
+      Data.Hash = OtherData.Hash;
+      Data.Counts.swap(OtherData.Counts);
+      continue;
+    }
+    if (std::error_code EC =
+            addCounts(Where->getValue(), OtherData.Hash, OtherData.Counts))
+      Warn(I.getKey(), EC);
   }
-  return instrprof_error::success;
+  Other.FunctionData.clear();
+}
+
+size_t InstrProfWriter::removeColdFunctions(uint64_t MinFunctionCount) {
+  size_t NumRemoved = 0;
+  for (auto I = FunctionData.begin(), E = FunctionData.end(); I != E;) {
+    auto Current = I;
+    ++I;
+    if (Current->getValue().Counts[0] < MinFunctionCount) {
+      FunctionData.erase(Current);
+      ++NumRemoved;
+    }
+  }
+  return NumRemoved;
 }
 
 void InstrProfWriter::write(raw_fd_ostream &OS) {
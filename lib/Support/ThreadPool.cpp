@@ -0,0 +1,131 @@
+//==-- llvm/Support/ThreadPool.cpp - A ThreadPool implementation -*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a crude C++11 based thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include <cassert>
+
+using namespace llvm;
+
+#if LLVM_ENABLE_THREADS
+
+unsigned ThreadPool::getThreadCount(unsigned ThreadCount) {
+  if (ThreadCount)
+    return ThreadCount;
+  unsigned HardwareThreads = std::thread::hardware_concurrency();
+  return HardwareThreads ? HardwareThreads : 1;
+}
+
+ThreadPool::ThreadPool() : ActiveThreads(0), EnableFlag(true) {
+  startThreads(getThreadCount());
+}
+
+ThreadPool::ThreadPool(unsigned ThreadCount)
+    : ActiveThreads(0), EnableFlag(true) {
+  startThreads(getThreadCount(ThreadCount));
+}
+
+void ThreadPool::startThreads(unsigned ThreadCount) {
+  // Tasks use ManagedStatics, statistics and SmartMutexes, which only lock
+  // once LLVM is in multithreaded mode.  Pools may be created concurrently,
+  // so serialize the check.
+  {
+    static std::mutex StartLock;
+    std::lock_guard<std::mutex> LockGuard(StartLock);
+    if (!llvm_is_multithreaded())
+      llvm_start_multithreaded();
+  }
+
+  Threads.reserve(ThreadCount);
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    Threads.emplace_back([this] { workerLoop(); });
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    TaskTy Task;
+    {
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      // Wait for tasks to be pushed in the queue.
+      QueueCondition.wait(LockGuard,
+                          [&] { return !EnableFlag || !Tasks.empty(); });
+      // Exit condition.
+      if (!EnableFlag && Tasks.empty())
+        return;
+      // Claim the task while holding the lock, so that wait() never sees an
+      // empty queue while a task is neither queued nor marked active.
+      ++ActiveThreads;
+      Task = std::move(Tasks.front());
+      Tasks.pop();
+    }
+    Task();
+    {
+      // Adjust the count of active tasks, and notify waiters.
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      --ActiveThreads;
+    }
+    CompletionCondition.notify_all();
+  }
+}
+
+void ThreadPool::wait() {
+  // Wait for all threads to complete and the queue to be empty.
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
+  CompletionCondition.wait(LockGuard,
+                           [&] { return Tasks.empty() && !ActiveThreads; });
+}
+
+void ThreadPool::async(TaskTy Task) {
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    assert(EnableFlag && "Queuing a task during the pool destruction");
+    Tasks.push(std::move(Task));
+  }
+  QueueCondition.notify_one();
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    EnableFlag = false;
+  }
+  QueueCondition.notify_all();
+  for (auto &Worker : Threads)
+    Worker.join();
+}
+
+#else // LLVM_ENABLE_THREADS Disabled
+
+unsigned ThreadPool::getThreadCount(unsigned ThreadCount) { return 1; }
+
+ThreadPool::ThreadPool() {}
+
+ThreadPool::ThreadPool(unsigned ThreadCount) {}
+
+void ThreadPool::wait() {
+  // Sequential implementation running the tasks.
+  while (!Tasks.empty()) {
+    TaskTy Task = std::move(Tasks.front());
+    Tasks.pop();
+    Task();
+  }
+}
+
+void ThreadPool::async(TaskTy Task) {
+  // Queue the task; it runs at the next wait().
+  Tasks.push(std::move(Task));
+}
+
+ThreadPool::~ThreadPool() { wait(); }
+
+#endif
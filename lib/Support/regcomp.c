@@ -103,6 +103,7 @@ static void dofwd(struct parse *, sopno, sop);
 static void enlarge(struct parse *, sopno);
 static void stripsnug(struct parse *, struct re_guts *);
 static void findmust(struct parse *, struct re_guts *);
+static void findprefix(struct parse *, struct re_guts *);
 static sopno pluscount(struct parse *, struct re_guts *);
 
 static char nuls[10];		/* place to point scanner in event of error */
@@ -211,6 +212,8 @@ llvm_regcomp(llvm_regex_t *preg, const char *pattern, int cflags)
 	g->neol = 0;
 	g->must = NULL;
 	g->mlen = 0;
+	g->prefix = NULL;
+	g->plen = 0;
 	g->nsub = 0;
 	g->ncategories = 1;	/* category 0 is "everything else" */
 	g->categories = &g->catspace[-(CHAR_MIN)];
@@ -233,6 +236,7 @@ llvm_regcomp(llvm_regex_t *preg, const char *pattern, int cflags)
 	categorize(p, g);
 	stripsnug(p, g);
 	findmust(p, g);
+	findprefix(p, g);
 	g->nplus = pluscount(p, g);
 	g->magic = MAGIC2;
 	preg->re_nsub = g->nsub;
@@ -1519,6 +1523,50 @@ findmust(struct parse *p, struct re_guts *g)
 	*cp++ = '\0';		/* just on general principles */
 }
 
+/*
+ - findprefix - fill in prefix and plen with the literal string every match
+ - starts with
+ *
+ * Only a leading run of OCHARs counts; parentheses are zero-width and do
+ * not break the run.  The matcher uses this to skip straight to the first
+ * place a match could begin.
+ *
+ * Note that prefix and plen got initialized during setup.
+ */
+static void
+findprefix(struct parse *p, struct re_guts *g)
+{
+	sop *scan;
+	sop s;
+	char *cp;
+	sopno len;
+
+	/* avoid making error situations worse */
+	if (p->error != 0 || (g->iflags&REGEX_BAD))
+		return;
+
+	len = 0;
+	for (scan = g->strip + g->firststate + 1; ; scan++) {
+		s = *scan;
+		if (OP(s) == OCHAR)
+			len++;
+		else if (OP(s) != OLPAREN && OP(s) != ORPAREN)
+			break;
+	}
+	if (len == 0)		/* there isn't one */
+		return;
+
+	g->prefix = malloc((size_t)len + 1);
+	if (g->prefix == NULL)		/* no matter; it's only an optimization */
+		return;
+	g->plen = len;
+	cp = g->prefix;
+	for (scan = g->strip + g->firststate + 1; cp < g->prefix + len; scan++)
+		if (OP(*scan) == OCHAR)
+			*cp++ = (char)OPND(*scan);
+	*cp = '\0';
+}
+
 /*
  - pluscount - count + nesting
  */
@@ -148,6 +148,8 @@ struct re_guts {
 	cat_t *categories;	/* ->catspace[-CHAR_MIN] */
 	char *must;		/* match must contain this string */
 	int mlen;		/* length of must */
+	char *prefix;		/* match must start with this string */
+	int plen;		/* length of prefix */
 	size_t nsub;		/* copy of re_nsub */
 	int backrefs;		/* does it use back references? */
 	sopno nplus;		/* how deep does it nest +s? */
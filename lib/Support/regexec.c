@@ -53,6 +53,16 @@
 #include "regutils.h"
 #include "regex2.h"
 
+/* transition cache entry, see cachedstep() in regengine.inc */
+struct stepcache {
+	long bef;		/* states before */
+	long aft;		/* states already known reachable after */
+	int ch;			/* character or NONCHAR code; OUT if unused */
+	long res;		/* what step() returned */
+};
+#define	STEPCACHESIZE	1024	/* entries, a power of two */
+#define	STEPCACHEMIN	256	/* shorter subjects are not worth a cache */
+
 /* macros for manipulating states, small version */
 /* FIXME: 'states' is assumed as 'long' on small version. */
 #define	states1	long		/* for later use in llvm_regexec() decision */
@@ -63,9 +73,9 @@
 #define	ISSET(v, n)	(((v) & ((unsigned long)1 << (n))) != 0)
 #define	ASSIGN(d, s)	((d) = (s))
 #define	EQ(a, b)	((a) == (b))
-#define	STATEVARS	long dummy	/* dummy version */
-#define	STATESETUP(m, n)	/* nothing */
-#define	STATETEARDOWN(m)	/* nothing */
+#define	STATEVARS	struct stepcache *cache
+#define	STATESETUP(m, n)	((m)->cache = NULL)
+#define	STATETEARDOWN(m)	{ free((m)->cache); }
 #define	SETUP(v)	((v) = 0)
 #define	onestate	long
 #define	INIT(o, n)	((o) = (unsigned long)1 << (n))
@@ -45,6 +45,12 @@ namespace {
   cl::list<std::string>
   IncludeDirs("I", cl::desc("Directory of include files"),
               cl::value_desc("directory"), cl::Prefix);
+
+  cl::list<std::string>
+  ExtraOutputs("write-output",
+               cl::desc("Also perform an action on the same records and "
+                        "write its output to a file"),
+               cl::value_desc("action=filename"));
 }
 
 /// \brief Create a dependency file for `-d` option.
@@ -75,9 +81,47 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
+/// \brief Perform each action requested with `-write-output`.
+///
+/// The records are parsed once and shared by every action, which is much
+/// cheaper than running tblgen once per output for large targets.  Actions
+/// run one after another: backends intern Inits in global tables and may
+/// annotate the records they read, so they cannot share them concurrently.
+static int writeExtraOutputs(RecordKeeper &Records, const char *argv0,
+                             TableGenActionFn *ActionFn) {
+  for (unsigned i = 0, e = ExtraOutputs.size(); i != e; ++i) {
+    std::pair<StringRef, StringRef> Spec =
+        StringRef(ExtraOutputs[i]).split('=');
+    if (Spec.first.empty() || Spec.second.empty()) {
+      errs() << argv0 << ": -write-output expects <action>=<filename>, got '"
+             << ExtraOutputs[i] << "'\n";
+      return 1;
+    }
+    if (!ActionFn) {
+      errs() << argv0 << ": this tool does not support -write-output\n";
+      return 1;
+    }
+
+    std::string Error;
+    tool_output_file Out(Spec.second.str().c_str(), Error, sys::fs::F_Text);
+    if (!Error.empty()) {
+      errs() << argv0 << ": error opening " << Spec.second
+        << ":" << Error << "\n";
+      return 1;
+    }
+    if (ActionFn(Out.os(), Records, Spec.first))
+      return 1;
+    if (ErrorsPrinted > 0)
+      break; // TableGenMain reports the errors.
+    Out.keep();
+  }
+  return 0;
+}
+
 namespace llvm {
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 TableGenActionFn *ActionFn) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -116,6 +160,11 @@ int TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   if (MainFn(Out.os(), Records))
     return 1;
 
+  if (ErrorsPrinted == 0) {
+    if (int Ret = writeExtraOutputs(Records, argv0, ActionFn))
+      return Ret;
+  }
+
   if (ErrorsPrinted > 0) {
     errs() << argv0 << ": " << ErrorsPrinted << " errors.\n";
     return 1;
@@ -0,0 +1,7 @@
+; RUN:  not llvm-dis < %s.bc 2>&1 | FileCheck %s
+
+; CHECK: llvm-dis{{(\.EXE|\.exe)?}}: Invalid record
+
+; invalid-code-width.ll.bc declares a 34-bit abbrev ID width for the module
+; block.  Abbrev IDs are read 32 bits at a time at most, so the block must be
+; rejected instead of being decoded as garbage.
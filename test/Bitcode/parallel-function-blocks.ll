@@ -0,0 +1,66 @@
+; Function blocks encoded on several threads must give the same bitcode as
+; encoding them one after the other.
+; RUN: llvm-as < %s > %t.serial.bc
+; RUN: llvm-as -bitcode-writer-threads=3 < %s > %t.parallel.bc
+; RUN: cmp %t.serial.bc %t.parallel.bc
+; RUN: llvm-dis < %t.parallel.bc | FileCheck %s
+
+@table = global [2 x i8*] [i8* blockaddress(@jump, %one), i8* blockaddress(@jump, %two)]
+@str = private constant [6 x i8] c"hello\00"
+
+; CHECK: define i32 @add(i32 %a, i32 %b)
+define i32 @add(i32 %a, i32 %b) #0 {
+entry:
+  %sum = add nsw i32 %a, %b, !dbg !5
+  %big = mul i32 %sum, 100000, !dbg !5
+  ret i32 %big, !dbg !6
+}
+
+; CHECK: define i32 @jump(i32 %i)
+define i32 @jump(i32 %i) {
+entry:
+  %slot = getelementptr [2 x i8*]* @table, i32 0, i32 %i
+  %dest = load i8** %slot, !tbaa !7
+  indirectbr i8* %dest, [label %one, label %two]
+one:
+  ret i32 1
+two:
+  ret i32 2
+}
+
+; CHECK: define i8* @vector(<4 x i32> %v)
+define i8* @vector(<4 x i32> %v) {
+  %w = add <4 x i32> %v, <i32 1, i32 2, i32 3, i32 4>
+  %e = extractelement <4 x i32> %w, i32 2
+  %c = call i32 @add(i32 %e, i32 7) nounwind
+  ret i8* getelementptr inbounds ([6 x i8]* @str, i32 0, i32 0)
+}
+
+; CHECK: define double @float(double %x)
+define double @float(double %x) {
+  %y = fmul double %x, 2.500000e+00
+  %z = fadd double %y, 0x7FF8000000000000
+  ret double %z
+}
+
+; CHECK: define void @empty()
+define void @empty() {
+  ret void
+}
+
+declare void @external()
+
+attributes #0 = { nounwind readnone }
+
+!llvm.dbg.cu = !{}
+!llvm.module.flags = !{!0}
+
+!0 = metadata !{i32 2, metadata !"Debug Info Version", i32 1}
+!1 = metadata !{metadata !"add.c", metadata !""}
+!2 = metadata !{}
+!3 = metadata !{i32 786473, metadata !1}
+!4 = metadata !{i32 786478, metadata !1, metadata !3, metadata !"add", metadata !"add", metadata !"", i32 1, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 256, i1 false, i32 (i32, i32)* @add, null, null, metadata !2, i32 1}
+!5 = metadata !{i32 2, i32 3, metadata !4, null}
+!6 = metadata !{i32 3, i32 3, metadata !4, null}
+!7 = metadata !{metadata !"any pointer", metadata !8}
+!8 = metadata !{metadata !"tbaa root"}
@@ -0,0 +1,52 @@
+; Skipping interference queries for register units with nothing assigned in
+; the blocks a live range covers must not change the allocation.
+; RUN: llc < %s -mtriple=i386-unknown-unknown -verify-machineinstrs > %t.filter
+; RUN: llc < %s -mtriple=i386-unknown-unknown -verify-machineinstrs \
+; RUN:   -disable-liveregmatrix-block-filter > %t.nofilter
+; RUN: diff %t.filter %t.nofilter
+
+define i32 @pressure(i32* %p, i32 %n) {
+entry:
+  %a = load i32* %p
+  %p1 = getelementptr inbounds i32* %p, i32 1
+  %b = load i32* %p1
+  %p2 = getelementptr inbounds i32* %p, i32 2
+  %c = load i32* %p2
+  %p3 = getelementptr inbounds i32* %p, i32 3
+  %d = load i32* %p3
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %latch ]
+  %gep = getelementptr inbounds i32* %p, i32 %i
+  %v = load i32* %gep
+  %x = mul i32 %v, %a
+  %y = xor i32 %x, %b
+  %odd = and i32 %v, 1
+  %isodd = icmp ne i32 %odd, 0
+  br i1 %isodd, label %then, label %else
+
+then:
+  %t = add i32 %y, %c
+  br label %latch
+
+else:
+  %e = sub i32 %y, %d
+  %e2 = mul i32 %e, %i
+  br label %latch
+
+latch:
+  %m = phi i32 [ %t, %then ], [ %e2, %else ]
+  %acc.next = add i32 %acc, %m
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %latch ]
+  %s = add i32 %r, %a
+  %s2 = add i32 %s, %d
+  ret i32 %s2
+}
@@ -0,0 +1,41 @@
+; Computing live intervals on several threads must give the same code as the
+; serial computation.
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-machineinstrs > %t.serial
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-machineinstrs \
+; RUN:   -live-interval-threads=4 -parallel-live-interval-threshold=1 > %t.parallel
+; RUN: diff %t.serial %t.parallel
+
+define i32 @sum(i32* %p, i32 %n, i32 %k) {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %latch ]
+  %gep = getelementptr inbounds i32* %p, i32 %i
+  %v = load i32* %gep
+  %odd = and i32 %v, 1
+  %isodd = icmp ne i32 %odd, 0
+  br i1 %isodd, label %then, label %else
+
+then:
+  %m = mul i32 %v, %k
+  br label %latch
+
+else:
+  %d = sdiv i32 %v, 3
+  %unused = add i32 %d, %k
+  br label %latch
+
+latch:
+  %t = phi i32 [ %m, %then ], [ %d, %else ]
+  %acc.next = add i32 %acc, %t
+  %i.next = add nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %latch ]
+  ret i32 %r
+}
@@ -0,0 +1,90 @@
+; A loop with more values live across a call than there are callee-saved
+; registers, so that the greedy allocator has to evict and split ranges that
+; span several blocks.  With a tiny budget it must still produce valid code,
+; falling back to spilling.
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc=greedy \
+; RUN:   -regalloc-greedy-report-work -verify-machineinstrs 2>&1 >/dev/null \
+; RUN:   | FileCheck %s --check-prefix=UNLIMITED
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc=greedy \
+; RUN:   -regalloc-greedy-budget=1 -regalloc-greedy-report-work \
+; RUN:   -verify-machineinstrs 2>&1 >/dev/null | FileCheck %s --check-prefix=BUDGET
+
+; UNLIMITED: greedy: pressure: {{[1-9][0-9]*}} work units{{$}}
+; BUDGET: greedy: pressure: {{[1-9][0-9]*}} work units, over budget
+
+declare void @clobber()
+
+define void @pressure(i64* %p, i32 %n) {
+entry:
+  %a0 = getelementptr inbounds i64* %p, i64 0
+  %v0 = load volatile i64* %a0
+  %a1 = getelementptr inbounds i64* %p, i64 1
+  %v1 = load volatile i64* %a1
+  %a2 = getelementptr inbounds i64* %p, i64 2
+  %v2 = load volatile i64* %a2
+  %a3 = getelementptr inbounds i64* %p, i64 3
+  %v3 = load volatile i64* %a3
+  %a4 = getelementptr inbounds i64* %p, i64 4
+  %v4 = load volatile i64* %a4
+  %a5 = getelementptr inbounds i64* %p, i64 5
+  %v5 = load volatile i64* %a5
+  %a6 = getelementptr inbounds i64* %p, i64 6
+  %v6 = load volatile i64* %a6
+  %a7 = getelementptr inbounds i64* %p, i64 7
+  %v7 = load volatile i64* %a7
+  %a8 = getelementptr inbounds i64* %p, i64 8
+  %v8 = load volatile i64* %a8
+  %a9 = getelementptr inbounds i64* %p, i64 9
+  %v9 = load volatile i64* %a9
+  %a10 = getelementptr inbounds i64* %p, i64 10
+  %v10 = load volatile i64* %a10
+  %a11 = getelementptr inbounds i64* %p, i64 11
+  %v11 = load volatile i64* %a11
+  %a12 = getelementptr inbounds i64* %p, i64 12
+  %v12 = load volatile i64* %a12
+  %a13 = getelementptr inbounds i64* %p, i64 13
+  %v13 = load volatile i64* %a13
+  %a14 = getelementptr inbounds i64* %p, i64 14
+  %v14 = load volatile i64* %a14
+  %a15 = getelementptr inbounds i64* %p, i64 15
+  %v15 = load volatile i64* %a15
+  %a16 = getelementptr inbounds i64* %p, i64 16
+  %v16 = load volatile i64* %a16
+  %a17 = getelementptr inbounds i64* %p, i64 17
+  %v17 = load volatile i64* %a17
+  %a18 = getelementptr inbounds i64* %p, i64 18
+  %v18 = load volatile i64* %a18
+  %a19 = getelementptr inbounds i64* %p, i64 19
+  %v19 = load volatile i64* %a19
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  call void @clobber()
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  store volatile i64 %v19, i64* %a19
+  store volatile i64 %v18, i64* %a18
+  store volatile i64 %v17, i64* %a17
+  store volatile i64 %v16, i64* %a16
+  store volatile i64 %v15, i64* %a15
+  store volatile i64 %v14, i64* %a14
+  store volatile i64 %v13, i64* %a13
+  store volatile i64 %v12, i64* %a12
+  store volatile i64 %v11, i64* %a11
+  store volatile i64 %v10, i64* %a10
+  store volatile i64 %v9, i64* %a9
+  store volatile i64 %v8, i64* %a8
+  store volatile i64 %v7, i64* %a7
+  store volatile i64 %v6, i64* %a6
+  store volatile i64 %v5, i64* %a5
+  store volatile i64 %v4, i64* %a4
+  store volatile i64 %v3, i64* %a3
+  store volatile i64 %v2, i64* %a2
+  store volatile i64 %v1, i64* %a1
+  store volatile i64 %v0, i64* %a0
+  ret void
+}
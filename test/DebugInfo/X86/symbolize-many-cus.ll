@@ -0,0 +1,290 @@
+; Symbolizing addresses in more compile units than DWARFContext keeps parsed
+; must still find the right function and line, including for the units whose
+; DIEs and line tables were released and have to be parsed again.
+
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -filetype=obj %s -o %t.o
+; RUN: echo 0x0 > %t.input
+; RUN: echo 0x10 >> %t.input
+; RUN: echo 0x20 >> %t.input
+; RUN: echo 0x30 >> %t.input
+; RUN: echo 0x40 >> %t.input
+; RUN: echo 0x50 >> %t.input
+; RUN: echo 0x60 >> %t.input
+; RUN: echo 0x70 >> %t.input
+; RUN: echo 0x80 >> %t.input
+; RUN: echo 0x90 >> %t.input
+; RUN: echo 0xa0 >> %t.input
+; RUN: echo 0xb0 >> %t.input
+; RUN: echo 0xc0 >> %t.input
+; RUN: echo 0xd0 >> %t.input
+; RUN: echo 0xe0 >> %t.input
+; RUN: echo 0xf0 >> %t.input
+; RUN: echo 0x100 >> %t.input
+; RUN: echo 0x110 >> %t.input
+; RUN: echo 0x120 >> %t.input
+; RUN: echo 0x130 >> %t.input
+; RUN: echo 0x0 >> %t.input
+; RUN: echo 0x10 >> %t.input
+; RUN: echo 0x20 >> %t.input
+; RUN: echo 0x30 >> %t.input
+; RUN: llvm-symbolizer -obj=%t.o < %t.input | FileCheck %s
+
+; Each function is 16 bytes long, and the first four are looked up again after
+; their units have been evicted.
+; CHECK: {{^}}f0{{$}}
+; CHECK-NEXT: /tmp/cu0.c:1:0
+; CHECK: {{^}}f1{{$}}
+; CHECK-NEXT: /tmp/cu1.c:2:0
+; CHECK: {{^}}f2{{$}}
+; CHECK-NEXT: /tmp/cu2.c:3:0
+; CHECK: {{^}}f3{{$}}
+; CHECK-NEXT: /tmp/cu3.c:4:0
+; CHECK: {{^}}f4{{$}}
+; CHECK-NEXT: /tmp/cu4.c:5:0
+; CHECK: {{^}}f5{{$}}
+; CHECK-NEXT: /tmp/cu5.c:6:0
+; CHECK: {{^}}f6{{$}}
+; CHECK-NEXT: /tmp/cu6.c:7:0
+; CHECK: {{^}}f7{{$}}
+; CHECK-NEXT: /tmp/cu7.c:8:0
+; CHECK: {{^}}f8{{$}}
+; CHECK-NEXT: /tmp/cu8.c:9:0
+; CHECK: {{^}}f9{{$}}
+; CHECK-NEXT: /tmp/cu9.c:10:0
+; CHECK: {{^}}f10{{$}}
+; CHECK-NEXT: /tmp/cu10.c:11:0
+; CHECK: {{^}}f11{{$}}
+; CHECK-NEXT: /tmp/cu11.c:12:0
+; CHECK: {{^}}f12{{$}}
+; CHECK-NEXT: /tmp/cu12.c:13:0
+; CHECK: {{^}}f13{{$}}
+; CHECK-NEXT: /tmp/cu13.c:14:0
+; CHECK: {{^}}f14{{$}}
+; CHECK-NEXT: /tmp/cu14.c:15:0
+; CHECK: {{^}}f15{{$}}
+; CHECK-NEXT: /tmp/cu15.c:16:0
+; CHECK: {{^}}f16{{$}}
+; CHECK-NEXT: /tmp/cu16.c:17:0
+; CHECK: {{^}}f17{{$}}
+; CHECK-NEXT: /tmp/cu17.c:18:0
+; CHECK: {{^}}f18{{$}}
+; CHECK-NEXT: /tmp/cu18.c:19:0
+; CHECK: {{^}}f19{{$}}
+; CHECK-NEXT: /tmp/cu19.c:20:0
+; CHECK: {{^}}f0{{$}}
+; CHECK-NEXT: /tmp/cu0.c:1:0
+; CHECK: {{^}}f1{{$}}
+; CHECK-NEXT: /tmp/cu1.c:2:0
+; CHECK: {{^}}f2{{$}}
+; CHECK-NEXT: /tmp/cu2.c:3:0
+; CHECK: {{^}}f3{{$}}
+; CHECK-NEXT: /tmp/cu3.c:4:0
+
+define void @f0() {
+  ret void, !dbg !10
+}
+
+define void @f1() {
+  ret void, !dbg !16
+}
+
+define void @f2() {
+  ret void, !dbg !22
+}
+
+define void @f3() {
+  ret void, !dbg !28
+}
+
+define void @f4() {
+  ret void, !dbg !34
+}
+
+define void @f5() {
+  ret void, !dbg !40
+}
+
+define void @f6() {
+  ret void, !dbg !46
+}
+
+define void @f7() {
+  ret void, !dbg !52
+}
+
+define void @f8() {
+  ret void, !dbg !58
+}
+
+define void @f9() {
+  ret void, !dbg !64
+}
+
+define void @f10() {
+  ret void, !dbg !70
+}
+
+define void @f11() {
+  ret void, !dbg !76
+}
+
+define void @f12() {
+  ret void, !dbg !82
+}
+
+define void @f13() {
+  ret void, !dbg !88
+}
+
+define void @f14() {
+  ret void, !dbg !94
+}
+
+define void @f15() {
+  ret void, !dbg !100
+}
+
+define void @f16() {
+  ret void, !dbg !106
+}
+
+define void @f17() {
+  ret void, !dbg !112
+}
+
+define void @f18() {
+  ret void, !dbg !118
+}
+
+define void @f19() {
+  ret void, !dbg !124
+}
+
+!llvm.dbg.cu = !{!5, !11, !17, !23, !29, !35, !41, !47, !53, !59, !65, !71, !77, !83, !89, !95, !101, !107, !113, !119}
+!llvm.module.flags = !{!3, !4}
+
+!0 = metadata !{}
+!1 = metadata !{null}
+!2 = metadata !{i32 786453, i32 0, null, metadata !"", i32 0, i64 0, i64 0, i64 0, i32 0, null, metadata !1, i32 0, null, null, null} ; [ DW_TAG_subroutine_type ] [line 0, size 0, align 0, offset 0] [from ]
+!3 = metadata !{i32 2, metadata !"Dwarf Version", i32 4}
+!4 = metadata !{i32 1, metadata !"Debug Info Version", i32 1}
+!5 = metadata !{i32 786449, metadata !6, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !7, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu0.c] [DW_LANG_C99]
+!6 = metadata !{metadata !"cu0.c", metadata !"/tmp"}
+!7 = metadata !{metadata !8}
+!8 = metadata !{i32 786478, metadata !6, metadata !9, metadata !"f0", metadata !"f0", metadata !"", i32 1, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f0, null, null, metadata !0, i32 1} ; [ DW_TAG_subprogram ] [line 1] [def] [f0]
+!9 = metadata !{i32 786473, metadata !6} ; [ DW_TAG_file_type ] [/tmp/cu0.c]
+!10 = metadata !{i32 1, i32 0, metadata !8, null}
+!11 = metadata !{i32 786449, metadata !12, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !13, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu1.c] [DW_LANG_C99]
+!12 = metadata !{metadata !"cu1.c", metadata !"/tmp"}
+!13 = metadata !{metadata !14}
+!14 = metadata !{i32 786478, metadata !12, metadata !15, metadata !"f1", metadata !"f1", metadata !"", i32 2, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f1, null, null, metadata !0, i32 2} ; [ DW_TAG_subprogram ] [line 2] [def] [f1]
+!15 = metadata !{i32 786473, metadata !12} ; [ DW_TAG_file_type ] [/tmp/cu1.c]
+!16 = metadata !{i32 2, i32 0, metadata !14, null}
+!17 = metadata !{i32 786449, metadata !18, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !19, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu2.c] [DW_LANG_C99]
+!18 = metadata !{metadata !"cu2.c", metadata !"/tmp"}
+!19 = metadata !{metadata !20}
+!20 = metadata !{i32 786478, metadata !18, metadata !21, metadata !"f2", metadata !"f2", metadata !"", i32 3, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f2, null, null, metadata !0, i32 3} ; [ DW_TAG_subprogram ] [line 3] [def] [f2]
+!21 = metadata !{i32 786473, metadata !18} ; [ DW_TAG_file_type ] [/tmp/cu2.c]
+!22 = metadata !{i32 3, i32 0, metadata !20, null}
+!23 = metadata !{i32 786449, metadata !24, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !25, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu3.c] [DW_LANG_C99]
+!24 = metadata !{metadata !"cu3.c", metadata !"/tmp"}
+!25 = metadata !{metadata !26}
+!26 = metadata !{i32 786478, metadata !24, metadata !27, metadata !"f3", metadata !"f3", metadata !"", i32 4, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f3, null, null, metadata !0, i32 4} ; [ DW_TAG_subprogram ] [line 4] [def] [f3]
+!27 = metadata !{i32 786473, metadata !24} ; [ DW_TAG_file_type ] [/tmp/cu3.c]
+!28 = metadata !{i32 4, i32 0, metadata !26, null}
+!29 = metadata !{i32 786449, metadata !30, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !31, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu4.c] [DW_LANG_C99]
+!30 = metadata !{metadata !"cu4.c", metadata !"/tmp"}
+!31 = metadata !{metadata !32}
+!32 = metadata !{i32 786478, metadata !30, metadata !33, metadata !"f4", metadata !"f4", metadata !"", i32 5, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f4, null, null, metadata !0, i32 5} ; [ DW_TAG_subprogram ] [line 5] [def] [f4]
+!33 = metadata !{i32 786473, metadata !30} ; [ DW_TAG_file_type ] [/tmp/cu4.c]
+!34 = metadata !{i32 5, i32 0, metadata !32, null}
+!35 = metadata !{i32 786449, metadata !36, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !37, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu5.c] [DW_LANG_C99]
+!36 = metadata !{metadata !"cu5.c", metadata !"/tmp"}
+!37 = metadata !{metadata !38}
+!38 = metadata !{i32 786478, metadata !36, metadata !39, metadata !"f5", metadata !"f5", metadata !"", i32 6, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f5, null, null, metadata !0, i32 6} ; [ DW_TAG_subprogram ] [line 6] [def] [f5]
+!39 = metadata !{i32 786473, metadata !36} ; [ DW_TAG_file_type ] [/tmp/cu5.c]
+!40 = metadata !{i32 6, i32 0, metadata !38, null}
+!41 = metadata !{i32 786449, metadata !42, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !43, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu6.c] [DW_LANG_C99]
+!42 = metadata !{metadata !"cu6.c", metadata !"/tmp"}
+!43 = metadata !{metadata !44}
+!44 = metadata !{i32 786478, metadata !42, metadata !45, metadata !"f6", metadata !"f6", metadata !"", i32 7, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f6, null, null, metadata !0, i32 7} ; [ DW_TAG_subprogram ] [line 7] [def] [f6]
+!45 = metadata !{i32 786473, metadata !42} ; [ DW_TAG_file_type ] [/tmp/cu6.c]
+!46 = metadata !{i32 7, i32 0, metadata !44, null}
+!47 = metadata !{i32 786449, metadata !48, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !49, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu7.c] [DW_LANG_C99]
+!48 = metadata !{metadata !"cu7.c", metadata !"/tmp"}
+!49 = metadata !{metadata !50}
+!50 = metadata !{i32 786478, metadata !48, metadata !51, metadata !"f7", metadata !"f7", metadata !"", i32 8, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f7, null, null, metadata !0, i32 8} ; [ DW_TAG_subprogram ] [line 8] [def] [f7]
+!51 = metadata !{i32 786473, metadata !48} ; [ DW_TAG_file_type ] [/tmp/cu7.c]
+!52 = metadata !{i32 8, i32 0, metadata !50, null}
+!53 = metadata !{i32 786449, metadata !54, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !55, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu8.c] [DW_LANG_C99]
+!54 = metadata !{metadata !"cu8.c", metadata !"/tmp"}
+!55 = metadata !{metadata !56}
+!56 = metadata !{i32 786478, metadata !54, metadata !57, metadata !"f8", metadata !"f8", metadata !"", i32 9, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f8, null, null, metadata !0, i32 9} ; [ DW_TAG_subprogram ] [line 9] [def] [f8]
+!57 = metadata !{i32 786473, metadata !54} ; [ DW_TAG_file_type ] [/tmp/cu8.c]
+!58 = metadata !{i32 9, i32 0, metadata !56, null}
+!59 = metadata !{i32 786449, metadata !60, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !61, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu9.c] [DW_LANG_C99]
+!60 = metadata !{metadata !"cu9.c", metadata !"/tmp"}
+!61 = metadata !{metadata !62}
+!62 = metadata !{i32 786478, metadata !60, metadata !63, metadata !"f9", metadata !"f9", metadata !"", i32 10, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f9, null, null, metadata !0, i32 10} ; [ DW_TAG_subprogram ] [line 10] [def] [f9]
+!63 = metadata !{i32 786473, metadata !60} ; [ DW_TAG_file_type ] [/tmp/cu9.c]
+!64 = metadata !{i32 10, i32 0, metadata !62, null}
+!65 = metadata !{i32 786449, metadata !66, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !67, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu10.c] [DW_LANG_C99]
+!66 = metadata !{metadata !"cu10.c", metadata !"/tmp"}
+!67 = metadata !{metadata !68}
+!68 = metadata !{i32 786478, metadata !66, metadata !69, metadata !"f10", metadata !"f10", metadata !"", i32 11, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f10, null, null, metadata !0, i32 11} ; [ DW_TAG_subprogram ] [line 11] [def] [f10]
+!69 = metadata !{i32 786473, metadata !66} ; [ DW_TAG_file_type ] [/tmp/cu10.c]
+!70 = metadata !{i32 11, i32 0, metadata !68, null}
+!71 = metadata !{i32 786449, metadata !72, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !73, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu11.c] [DW_LANG_C99]
+!72 = metadata !{metadata !"cu11.c", metadata !"/tmp"}
+!73 = metadata !{metadata !74}
+!74 = metadata !{i32 786478, metadata !72, metadata !75, metadata !"f11", metadata !"f11", metadata !"", i32 12, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f11, null, null, metadata !0, i32 12} ; [ DW_TAG_subprogram ] [line 12] [def] [f11]
+!75 = metadata !{i32 786473, metadata !72} ; [ DW_TAG_file_type ] [/tmp/cu11.c]
+!76 = metadata !{i32 12, i32 0, metadata !74, null}
+!77 = metadata !{i32 786449, metadata !78, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !79, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu12.c] [DW_LANG_C99]
+!78 = metadata !{metadata !"cu12.c", metadata !"/tmp"}
+!79 = metadata !{metadata !80}
+!80 = metadata !{i32 786478, metadata !78, metadata !81, metadata !"f12", metadata !"f12", metadata !"", i32 13, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f12, null, null, metadata !0, i32 13} ; [ DW_TAG_subprogram ] [line 13] [def] [f12]
+!81 = metadata !{i32 786473, metadata !78} ; [ DW_TAG_file_type ] [/tmp/cu12.c]
+!82 = metadata !{i32 13, i32 0, metadata !80, null}
+!83 = metadata !{i32 786449, metadata !84, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !85, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu13.c] [DW_LANG_C99]
+!84 = metadata !{metadata !"cu13.c", metadata !"/tmp"}
+!85 = metadata !{metadata !86}
+!86 = metadata !{i32 786478, metadata !84, metadata !87, metadata !"f13", metadata !"f13", metadata !"", i32 14, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f13, null, null, metadata !0, i32 14} ; [ DW_TAG_subprogram ] [line 14] [def] [f13]
+!87 = metadata !{i32 786473, metadata !84} ; [ DW_TAG_file_type ] [/tmp/cu13.c]
+!88 = metadata !{i32 14, i32 0, metadata !86, null}
+!89 = metadata !{i32 786449, metadata !90, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !91, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu14.c] [DW_LANG_C99]
+!90 = metadata !{metadata !"cu14.c", metadata !"/tmp"}
+!91 = metadata !{metadata !92}
+!92 = metadata !{i32 786478, metadata !90, metadata !93, metadata !"f14", metadata !"f14", metadata !"", i32 15, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f14, null, null, metadata !0, i32 15} ; [ DW_TAG_subprogram ] [line 15] [def] [f14]
+!93 = metadata !{i32 786473, metadata !90} ; [ DW_TAG_file_type ] [/tmp/cu14.c]
+!94 = metadata !{i32 15, i32 0, metadata !92, null}
+!95 = metadata !{i32 786449, metadata !96, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !97, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu15.c] [DW_LANG_C99]
+!96 = metadata !{metadata !"cu15.c", metadata !"/tmp"}
+!97 = metadata !{metadata !98}
+!98 = metadata !{i32 786478, metadata !96, metadata !99, metadata !"f15", metadata !"f15", metadata !"", i32 16, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f15, null, null, metadata !0, i32 16} ; [ DW_TAG_subprogram ] [line 16] [def] [f15]
+!99 = metadata !{i32 786473, metadata !96} ; [ DW_TAG_file_type ] [/tmp/cu15.c]
+!100 = metadata !{i32 16, i32 0, metadata !98, null}
+!101 = metadata !{i32 786449, metadata !102, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !103, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu16.c] [DW_LANG_C99]
+!102 = metadata !{metadata !"cu16.c", metadata !"/tmp"}
+!103 = metadata !{metadata !104}
+!104 = metadata !{i32 786478, metadata !102, metadata !105, metadata !"f16", metadata !"f16", metadata !"", i32 17, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f16, null, null, metadata !0, i32 17} ; [ DW_TAG_subprogram ] [line 17] [def] [f16]
+!105 = metadata !{i32 786473, metadata !102} ; [ DW_TAG_file_type ] [/tmp/cu16.c]
+!106 = metadata !{i32 17, i32 0, metadata !104, null}
+!107 = metadata !{i32 786449, metadata !108, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !109, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu17.c] [DW_LANG_C99]
+!108 = metadata !{metadata !"cu17.c", metadata !"/tmp"}
+!109 = metadata !{metadata !110}
+!110 = metadata !{i32 786478, metadata !108, metadata !111, metadata !"f17", metadata !"f17", metadata !"", i32 18, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f17, null, null, metadata !0, i32 18} ; [ DW_TAG_subprogram ] [line 18] [def] [f17]
+!111 = metadata !{i32 786473, metadata !108} ; [ DW_TAG_file_type ] [/tmp/cu17.c]
+!112 = metadata !{i32 18, i32 0, metadata !110, null}
+!113 = metadata !{i32 786449, metadata !114, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !115, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu18.c] [DW_LANG_C99]
+!114 = metadata !{metadata !"cu18.c", metadata !"/tmp"}
+!115 = metadata !{metadata !116}
+!116 = metadata !{i32 786478, metadata !114, metadata !117, metadata !"f18", metadata !"f18", metadata !"", i32 19, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f18, null, null, metadata !0, i32 19} ; [ DW_TAG_subprogram ] [line 19] [def] [f18]
+!117 = metadata !{i32 786473, metadata !114} ; [ DW_TAG_file_type ] [/tmp/cu18.c]
+!118 = metadata !{i32 19, i32 0, metadata !116, null}
+!119 = metadata !{i32 786449, metadata !120, i32 12, metadata !"clang version 3.5.0", i1 true, metadata !"", i32 0, metadata !0, metadata !0, metadata !121, metadata !0, metadata !0, metadata !"", i32 1} ; [ DW_TAG_compile_unit ] [/tmp/cu19.c] [DW_LANG_C99]
+!120 = metadata !{metadata !"cu19.c", metadata !"/tmp"}
+!121 = metadata !{metadata !122}
+!122 = metadata !{i32 786478, metadata !120, metadata !123, metadata !"f19", metadata !"f19", metadata !"", i32 20, metadata !2, i1 false, i1 true, i32 0, i32 0, null, i32 0, i1 true, void ()* @f19, null, null, metadata !0, i32 20} ; [ DW_TAG_subprogram ] [line 20] [def] [f19]
+!123 = metadata !{i32 786473, metadata !120} ; [ DW_TAG_file_type ] [/tmp/cu19.c]
+!124 = metadata !{i32 20, i32 0, metadata !122, null}
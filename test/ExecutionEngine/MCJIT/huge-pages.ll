@@ -0,0 +1,5 @@
+; RUN: %lli_mcjit -jit-huge-pages %s > /dev/null
+
+define i32 @main() {
+  ret i32 0
+}
@@ -0,0 +1,14 @@
+; RUN: rm -rf %t.cache
+; RUN: %lli_mcjit -jit-cache-dir=%t.cache %s
+; RUN: ls %t.cache | count 1
+; RUN: %lli_mcjit -jit-cache-dir=%t.cache %s
+; RUN: ls %t.cache | count 1
+; RUN: %lli_mcjit -jit-cache-dir=%t.cache -O0 %s
+; RUN: ls %t.cache | count 2
+; RUN: %lli_mcjit -jit-cache-dir=%t.cache -jit-cache-size=1 %s
+; RUN: ls %t.cache | count 0
+
+define i32 @main() {
+entry:
+  ret i32 0
+}
@@ -0,0 +1,24 @@
+; REQUIRES: asserts
+; RUN: %lli_mcjit -lazy-function-compilation -debug-only=jit %s 2>&1 \
+; RUN:   | FileCheck %s
+
+; Only the functions that are reached get compiled.
+
+; CHECK-NOT: compiling function 'never_called'
+; CHECK: MCJIT: compiling function 'main'
+; CHECK: MCJIT: compiling function 'callee'
+; CHECK-NOT: compiling function 'never_called'
+
+define i32 @never_called(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
+
+define i32 @callee() {
+  ret i32 0
+}
+
+define i32 @main() {
+  %r = call i32 @callee()
+  ret i32 %r
+}
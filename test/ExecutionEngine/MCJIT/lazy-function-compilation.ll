@@ -0,0 +1,42 @@
+; RUN: %lli_mcjit -lazy-function-compilation %s > /dev/null
+; RUN: %lli_mcjit -lazy-function-compilation -background-compile %s > /dev/null
+
+; Functions split into their own modules must still reach the internal and
+; private symbols of the module they came from.
+
+@counter = internal global i32 0
+@message = private constant [3 x i8] c"ok\00"
+@table = global [2 x i32 ()*] [i32 ()* @one, i32 ()* @two]
+
+define internal i32 @one() {
+  ret i32 1
+}
+
+define internal i32 @two() {
+  ret i32 2
+}
+
+define i32 @never_called(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
+
+define internal void @bump() {
+  %v = load i32* @counter
+  %n = add i32 %v, 1
+  store i32 %n, i32* @counter
+  ret void
+}
+
+define i32 @main() {
+  call void @bump()
+  call void @bump()
+  %count = load i32* @counter
+  %fp = load i32 ()** getelementptr ([2 x i32 ()*]* @table, i32 0, i32 1)
+  %two = call i32 %fp()
+  %diff = sub i32 %count, %two
+  %ch = load i8* getelementptr ([3 x i8]* @message, i32 0, i32 0)
+  %isok = icmp eq i8 %ch, 111
+  %r = select i1 %isok, i32 %diff, i32 1
+  ret i32 %r
+}
@@ -0,0 +1,41 @@
+; RUN: %lli_mcjit -rtdyld-parallel-relocation-threshold=1 %s
+
+; Relocations into code, read-only data and writable data, against local,
+; cross-section and external symbols, all resolved on the thread pool.
+
+@str = private unnamed_addr constant [6 x i8] c"hello\00"
+@table = global [3 x i32 ()*] [i32 ()* @one, i32 ()* @two, i32 ()* @three]
+@ptr = global i8* getelementptr inbounds ([6 x i8]* @str, i32 0, i32 0)
+
+declare i64 @strlen(i8*)
+
+define i32 @one() {
+  ret i32 1
+}
+
+define i32 @two() {
+  ret i32 2
+}
+
+define i32 @three() {
+  ret i32 3
+}
+
+define i32 @main() {
+entry:
+  %f0 = load i32 ()** getelementptr inbounds ([3 x i32 ()*]* @table, i32 0, i32 0)
+  %f1 = load i32 ()** getelementptr inbounds ([3 x i32 ()*]* @table, i32 0, i32 1)
+  %f2 = load i32 ()** getelementptr inbounds ([3 x i32 ()*]* @table, i32 0, i32 2)
+  %r0 = call i32 %f0()
+  %r1 = call i32 %f1()
+  %r2 = call i32 %f2()
+  %s = load i8** @ptr
+  %len = call i64 @strlen(i8* %s)
+  %len32 = trunc i64 %len to i32
+  ; 1 + 2 + 3 + 5 - 11 == 0
+  %a = add i32 %r0, %r1
+  %b = add i32 %a, %r2
+  %c = add i32 %b, %len32
+  %d = sub i32 %c, 11
+  ret i32 %d
+}
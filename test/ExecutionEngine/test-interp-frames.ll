@@ -0,0 +1,39 @@
+; RUN: %lli -force-interpreter=true %s
+
+; Values live across recursive calls must stay in their own frame, and
+; instructions created by intrinsic lowering while running must be usable.
+
+@table = global [2 x i32] [i32 3, i32 5]
+
+declare i32 @llvm.ctpop.i32(i32)
+
+define i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %done, label %recurse
+
+recurse:
+  %n1 = sub i32 %n, 1
+  %f1 = call i32 @fib(i32 %n1)
+  %n2 = sub i32 %n, 2
+  %f2 = call i32 @fib(i32 %n2)
+  %sum = add i32 %f1, %f2
+  br label %done
+
+done:
+  %r = phi i32 [ %n, %entry ], [ %sum, %recurse ]
+  ret i32 %r
+}
+
+define i32 @main() {
+  %f = call i32 @fib(i32 10)
+  %bad.fib = icmp ne i32 %f, 55
+  %five = load i32* getelementptr ([2 x i32]* @table, i32 0, i32 1)
+  %bits = call i32 @llvm.ctpop.i32(i32 %five)
+  %bits.again = call i32 @llvm.ctpop.i32(i32 %f)
+  %total = add i32 %bits, %bits.again
+  %bad.bits = icmp ne i32 %total, 7
+  %bad = or i1 %bad.fib, %bad.bits
+  %ret = zext i1 %bad to i32
+  ret i32 %ret
+}
@@ -0,0 +1,19 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | llvm-objdump -d - | FileCheck %s
+
+// The first jump only goes out of range once the second one, which it spans,
+// has been relaxed. The last jump spans neither and stays short.
+
+// CHECK:   0: e9 81 00 00 00 jmp 129
+// CHECK:   5: e9 80 00 00 00 jmp 128
+// CHECK: 8a: eb 01 jmp 1
+
+        jmp L1
+        jmp L2
+        .fill 124, 1, 0x90
+L1:
+        .fill 4, 1, 0x90
+L2:
+        jmp L3
+        nop
+L3:
+        ret
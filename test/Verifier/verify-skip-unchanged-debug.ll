@@ -0,0 +1,25 @@
+; REQUIRES: asserts
+; RUN: opt < %s -verify-each -verify-skip-unchanged -instcombine -simplifycfg \
+; RUN:   -debug-only=verify -disable-output 2>&1 | FileCheck %s
+
+; Each function is verified after instcombine, which only rewrites @changed.
+; After simplifycfg, which changes @changed again, @unchanged is skipped.
+
+; CHECK: Verifying function 'changed'
+; CHECK-NEXT: Verifying function 'unchanged'
+; CHECK-NEXT: Verifying function 'changed'
+; CHECK-NEXT: Skipping unchanged function 'unchanged'
+; CHECK-NOT: function
+
+define i32 @changed(i32 %x) {
+  %a = add i32 %x, 0
+  br label %next
+
+next:
+  ret i32 %a
+}
+
+define i32 @unchanged(i32 %x, i32 %y) {
+  %a = mul i32 %x, %y
+  ret i32 %a
+}
@@ -0,0 +1,24 @@
+; Verifier passes between other passes may skip functions that have not
+; changed since they last passed, but must still see the rewritten ones.
+; RUN: opt < %s -verify-each -verify-skip-unchanged -instcombine -simplifycfg \
+; RUN:   -S | FileCheck %s
+
+; simplifycfg folds the entry block into its successor, which keeps its name.
+; CHECK-LABEL: @changed(
+; CHECK-NEXT: {{^}}next:
+; CHECK-NEXT: ret i32 %x
+define i32 @changed(i32 %x) {
+  %a = add i32 %x, 0
+  br label %next
+
+next:
+  ret i32 %a
+}
+
+; CHECK-LABEL: @unchanged(
+; CHECK-NEXT: %a = mul i32 %x, %y
+; CHECK-NEXT: ret i32 %a
+define i32 @unchanged(i32 %x, i32 %y) {
+  %a = mul i32 %x, %y
+  ret i32 %a
+}
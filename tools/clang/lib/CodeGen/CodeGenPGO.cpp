@@ -914,22 +914,21 @@ void CodeGenPGO::emitCounterIncrement(CGBuilderTy &Builder, unsigned Counter) {
 
 void CodeGenPGO::loadRegionCounts(llvm::IndexedInstrProfReader *PGOReader) {
   CGM.getPGOStats().Visited++;
-  RegionCounts.reset(new std::vector<uint64_t>);
   uint64_t Hash;
-  if (PGOReader->getFunctionCounts(getFuncName(), Hash, *RegionCounts)) {
+  if (PGOReader->getFunctionCounts(getFuncName(), Hash, RegionCounts)) {
     CGM.getPGOStats().Missing++;
-    RegionCounts.reset();
+    RegionCounts = None;
   } else if (Hash != FunctionHash ||
-             RegionCounts->size() != NumRegionCounters) {
+             RegionCounts.size() != NumRegionCounters) {
     CGM.getPGOStats().Mismatched++;
-    RegionCounts.reset();
+    RegionCounts = None;
   }
 }
 
 void CodeGenPGO::destroyRegionCounters() {
   RegionCounterMap.reset();
   StmtCountMap.reset();
-  RegionCounts.reset();
+  RegionCounts = None;
   RegionCounters = nullptr;
 }
 
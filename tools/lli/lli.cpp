@@ -20,6 +20,7 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
+#include "llvm/ExecutionEngine/FileObjectCache.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/Interpreter.h"
 #include "llvm/ExecutionEngine/JIT.h"
@@ -163,6 +164,27 @@ namespace {
                            "(must be user writable)"),
                   cl::init(""));
 
+  cl::opt<std::string>
+  JITCacheDir("jit-cache-dir",
+              cl::desc("Reuse objects compiled by MCJIT across runs, keyed by "
+                       "module contents and target, from this directory"),
+              cl::value_desc("directory"),
+              cl::init(""));
+
+  cl::opt<unsigned long long>
+  JITCacheSize("jit-cache-size",
+               cl::desc("Evict least recently used objects once the "
+                        "-jit-cache-dir directory exceeds this many bytes "
+                        "(0 means unlimited)"),
+               cl::value_desc("bytes"),
+               cl::init(0));
+
+  cl::opt<bool>
+  JITHugePages("jit-huge-pages",
+               cl::desc("Map MCJIT code in 2 MB slabs and ask the system to "
+                        "back them with huge pages"),
+               cl::init(false));
+
   cl::opt<std::string>
   FakeArgv0("fake-argv0",
             cl::desc("Override the 'argv[0]' value passed into the executing"
@@ -177,6 +199,19 @@ namespace {
                   cl::desc("Disable JIT lazy compilation"),
                   cl::init(false));
 
+  cl::opt<bool>
+  LazyFunctionCompilation("lazy-function-compilation",
+                  cl::desc("Compile each function the first time it is "
+                           "referenced instead of whole modules (MCJIT only)"),
+                  cl::init(false));
+
+  cl::opt<bool>
+  BackgroundCompile("background-compile",
+                  cl::desc("With -lazy-function-compilation, compile the "
+                           "functions of the main module on a background "
+                           "thread, most referenced first"),
+                  cl::init(false));
+
   cl::opt<Reloc::Model>
   RelocModel("relocation-model",
              cl::desc("Choose relocation model"),
@@ -321,7 +356,7 @@ private:
 };
 
 static ExecutionEngine *EE = nullptr;
-static LLIObjectCache *CacheManager = nullptr;
+static ObjectCache *CacheManager = nullptr;
 
 static void do_shutdown() {
   // Cygwin-1.5 invokes DLL's dtors before atexit handler.
@@ -456,7 +491,7 @@ int main(int argc, char **argv, char * const *envp) {
     if (RemoteMCJIT)
       RTDyldMM = new RemoteMemoryManager();
     else
-      RTDyldMM = new SectionMemoryManager();
+      RTDyldMM = new SectionMemoryManager(0, JITHugePages);
     builder.setMCJITMemoryManager(RTDyldMM);
   } else {
     if (RemoteMCJIT) {
@@ -504,7 +539,17 @@ int main(int argc, char **argv, char * const *envp) {
     exit(1);
   }
 
-  if (EnableCacheManager) {
+  if (!JITCacheDir.empty()) {
+    if (!UseMCJIT || ForceInterpreter) {
+      errs() << "warning: -jit-cache-dir can only be used with MCJIT.\n";
+    } else {
+      if (EnableCacheManager)
+        errs() << "warning: -jit-cache-dir overrides -enable-cache-manager.\n";
+      CacheManager = new FileObjectCache(JITCacheDir, *EE->getTargetMachine(),
+                                         JITCacheSize);
+      EE->setObjectCache(CacheManager);
+    }
+  } else if (EnableCacheManager) {
     CacheManager = new LLIObjectCache(ObjectCacheDir);
     EE->setObjectCache(CacheManager);
   }
@@ -572,6 +617,22 @@ int main(int argc, char **argv, char * const *envp) {
   }
   EE->DisableLazyCompilation(NoLazyCompilation);
 
+  if (LazyFunctionCompilation && RemoteMCJIT) {
+    errs() << "warning: remote mcjit does not support lazy function "
+              "compilation\n";
+    LazyFunctionCompilation = false;
+  }
+  // Rank the functions by how often they are referenced before their bodies
+  // are moved out of the module.
+  std::vector<std::pair<Function *, unsigned> > Precompile;
+  if (LazyFunctionCompilation) {
+    if (BackgroundCompile)
+      for (Module::iterator I = Mod->begin(), E = Mod->end(); I != E; ++I)
+        if (!I->isDeclaration())
+          Precompile.push_back(std::make_pair(&*I, I->getNumUses()));
+    EE->setLazyFunctionCompilation(true);
+  }
+
   // If the user specifically requested an argv[0] to pass into the program,
   // do it now.
   if (!FakeArgv0.empty()) {
@@ -631,9 +692,18 @@ int main(int argc, char **argv, char * const *envp) {
     if (RTDyldMM)
       static_cast<SectionMemoryManager*>(RTDyldMM)->invalidateInstructionCache();
 
+    // Start compiling in the background only once lli itself is done
+    // changing the IR.
+    for (unsigned i = 0, e = Precompile.size(); i != e; ++i)
+      EE->precompileFunction(Precompile[i].first, Precompile[i].second);
+
     // Run main.
     Result = EE->runFunctionAsMain(EntryFn, InputArgv, envp);
 
+    // Don't leave the compiler running while the program exits.
+    if (!Precompile.empty())
+      EE->setLazyFunctionCompilation(false);
+
     // Run static destructors.
     EE->runStaticConstructorsDestructors(true);
 
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Object/Archive.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -70,6 +72,11 @@ RestOfArgs(cl::Positional, cl::OneOrMore,
 
 std::string Options;
 
+static cl::opt<unsigned>
+NumThreads("num-threads", cl::init(0),
+           cl::desc("Number of threads used to read members for the symbol "
+                    "table (default: autodetect)"));
+
 // MoreHelp - Provide additional help output explaining the operations and
 // modifiers of llvm-ar. This object instructs the CommandLine library
 // to print the text of the constructor when the --help option is given.
@@ -680,60 +687,153 @@ static void writeStringTable(raw_fd_ostream &Out,
   Out.seek(Pos);
 }
 
+namespace {
+/// The symbol table entries contributed by one archive member.
+struct MemberSymbols {
+  MemberSymbols() : IsSymbolic(false), NumSymbols(0) {}
+
+  /// Whether the member could be read as a symbolic file.  Only those get
+  /// entries, and only their presence creates a symbol table.
+  bool IsSymbolic;
+  unsigned NumSymbols;
+  /// The names of the symbols, each followed by a NUL.
+  std::string Names;
+  std::error_code EC;
+};
+}
+
+static void readMemberSymbols(MemoryBuffer *MemberBuffer, LLVMContext &Context,
+                              MemberSymbols &Result) {
+  ErrorOr<object::SymbolicFile *> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, false, sys::fs::file_magic::unknown, &Context);
+  if (!ObjOrErr)
+    return;  // FIXME: check only for "not an object file" errors.
+  std::unique_ptr<object::SymbolicFile> Obj(ObjOrErr.get());
+  Result.IsSymbolic = true;
+
+  raw_string_ostream NameOS(Result.Names);
+  for (object::basic_symbol_iterator I = Obj->symbol_begin(),
+                                     E = Obj->symbol_end();
+       I != E; ++I) {
+    uint32_t Symflags = I->getFlags();
+    if (Symflags & object::SymbolRef::SF_FormatSpecific)
+      continue;
+    if (!(Symflags & object::SymbolRef::SF_Global))
+      continue;
+    if (Symflags & object::SymbolRef::SF_Undefined)
+      continue;
+    if ((Result.EC = I->printName(NameOS)))
+      return;
+    NameOS << '\0';
+    ++Result.NumSymbols;
+  }
+  NameOS.flush();
+}
+
+/// Collect the entries of the old archive's symbol table, keyed by the start
+/// of the member they belong to, so that members carried over unchanged do
+/// not have to be read again.
+static void
+collectOldSymbols(object::Archive *OldArchive,
+                  DenseMap<const char *, MemberSymbols> &OldSymbols) {
+  if (!OldArchive || !OldArchive->hasSymbolTable())
+    return;
+  for (object::Archive::symbol_iterator I = OldArchive->symbol_begin(),
+                                        E = OldArchive->symbol_end();
+       I != E; ++I) {
+    StringRef Name;
+    object::Archive::child_iterator Member;
+    if (I->getName(Name) || I->getMember(Member)) {
+      // Don't trust any of it.
+      OldSymbols.clear();
+      return;
+    }
+    MemberSymbols &Syms = OldSymbols[Member->getBuffer().data()];
+    Syms.IsSymbolic = true;
+    Syms.Names += Name;
+    Syms.Names += '\0';
+    ++Syms.NumSymbols;
+  }
+}
+
 static void writeSymbolTable(
     raw_fd_ostream &Out, ArrayRef<NewArchiveIterator> Members,
-    ArrayRef<MemoryBuffer *> Buffers,
+    ArrayRef<MemoryBuffer *> Buffers, object::Archive *OldArchive,
     std::vector<std::pair<unsigned, unsigned> > &MemberOffsetRefs) {
+  // Members taken unchanged from the old archive keep their entries in its
+  // symbol table.  Members without entries there may still be objects that
+  // just define no global symbols, so those are read like new members.
+  DenseMap<const char *, MemberSymbols> OldSymbols;
+  collectOldSymbols(OldArchive, OldSymbols);
+
+  std::vector<MemberSymbols> Symbols(Members.size());
+  std::vector<unsigned> ToRead;
+  for (unsigned MemberNum = 0, N = Members.size(); MemberNum != N;
+       ++MemberNum) {
+    const NewArchiveIterator &Member = Members[MemberNum];
+    if (!Member.isNewMember()) {
+      DenseMap<const char *, MemberSymbols>::iterator I =
+          OldSymbols.find(Member.getOld()->getBuffer().data());
+      if (I != OldSymbols.end()) {
+        std::swap(Symbols[MemberNum], I->second);
+        continue;
+      }
+    }
+    ToRead.push_back(MemberNum);
+  }
+
+  // Read the remaining members.  Each thread reads a contiguous slice of them
+  // in its own context, as bitcode members need one that is not shared.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = std::min<unsigned>(ThreadPool::getThreadCount(),
+                                 (ToRead.size() + 1) / 2);
+  Threads = std::max(1u, std::min<unsigned>(Threads, ToRead.size()));
+
+  ArrayRef<unsigned> Pending(ToRead);
+  MemberSymbols *Results = Symbols.data();
+  auto ReadSlice = [Pending, Buffers, Results](size_t Begin, size_t End) {
+    LLVMContext Context;
+    for (size_t I = Begin; I != End; ++I)
+      readMemberSymbols(Buffers[Pending[I]], Context, Results[Pending[I]]);
+  };
+  if (Threads == 1) {
+    ReadSlice(0, Pending.size());
+  } else {
+    ThreadPool Pool(Threads);
+    for (unsigned I = 0; I < Threads; ++I) {
+      size_t Begin = Pending.size() * I / Threads;
+      size_t End = Pending.size() * (I + 1) / Threads;
+      Pool.async([ReadSlice, Begin, End] { ReadSlice(Begin, End); });
+    }
+    Pool.wait();
+  }
+
   unsigned StartOffset = 0;
-  unsigned MemberNum = 0;
-  std::string NameBuf;
-  raw_string_ostream NameOS(NameBuf);
   unsigned NumSyms = 0;
-  std::vector<object::SymbolicFile *> DeleteIt;
-  LLVMContext &Context = getGlobalContext();
-  for (ArrayRef<NewArchiveIterator>::iterator I = Members.begin(),
-                                              E = Members.end();
-       I != E; ++I, ++MemberNum) {
-    MemoryBuffer *MemberBuffer = Buffers[MemberNum];
-    ErrorOr<object::SymbolicFile *> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, false, sys::fs::file_magic::unknown, &Context);
-    if (!ObjOrErr)
-      continue;  // FIXME: check only for "not an object file" errors.
-    object::SymbolicFile *Obj = ObjOrErr.get();
-
-    DeleteIt.push_back(Obj);
+  std::string NameBuf;
+  for (unsigned MemberNum = 0, N = Members.size(); MemberNum != N;
+       ++MemberNum) {
+    const MemberSymbols &Syms = Symbols[MemberNum];
+    failIfError(Syms.EC);
+    if (!Syms.IsSymbolic)
+      continue;
+
     if (!StartOffset) {
       printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
       StartOffset = Out.tell();
       print32BE(Out, 0);
     }
 
-    for (object::basic_symbol_iterator I = Obj->symbol_begin(),
-                                       E = Obj->symbol_end();
-         I != E; ++I) {
-      uint32_t Symflags = I->getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined)
-        continue;
-      failIfError(I->printName(NameOS));
-      NameOS << '\0';
-      ++NumSyms;
+    for (unsigned I = 0; I != Syms.NumSymbols; ++I) {
       MemberOffsetRefs.push_back(std::make_pair(Out.tell(), MemberNum));
       print32BE(Out, 0);
     }
+    NumSyms += Syms.NumSymbols;
+    NameBuf += Syms.Names;
   }
-  Out << NameOS.str();
-
-  for (std::vector<object::SymbolicFile *>::iterator I = DeleteIt.begin(),
-                                                     E = DeleteIt.end();
-       I != E; ++I) {
-    object::SymbolicFile *O = *I;
-    delete O;
-  }
+  Out << NameBuf;
 
   if (StartOffset == 0)
     return;
@@ -788,7 +888,8 @@ static void performWriteOperation(ArchiveOperation Operation,
   }
 
   if (Symtab) {
-    writeSymbolTable(Out, NewMembers, MemberBuffers, MemberOffsetRefs);
+    writeSymbolTable(Out, NewMembers, MemberBuffers, OldArchive,
+                     MemberOffsetRefs);
   }
 
   std::vector<unsigned> StringMapIndexes;
@@ -20,11 +20,14 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <system_error>
 using namespace llvm;
 
-static cl::opt<std::string> SourceFile(cl::Positional, cl::Required,
-                                       cl::desc("SOURCEFILE"));
+static cl::list<std::string> SourceFiles(cl::Positional, cl::OneOrMore,
+                                         cl::desc("SOURCEFILE..."));
 
 static cl::opt<bool> AllBlocks("a", cl::Grouping, cl::init(false),
                                cl::desc("Display all basic blocks"));
@@ -67,6 +70,13 @@ static cl::opt<bool> UncondBranch("u", cl::Grouping, cl::init(false),
 static cl::alias UncondBranchA("unconditional-branches",
                                cl::aliasopt(UncondBranch));
 
+static cl::opt<unsigned>
+NumThreads("num-threads", cl::init(0),
+           cl::desc("Number of threads used to process several source files "
+                    "(default: autodetect)"));
+static cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                             cl::aliasopt(NumThreads));
+
 static cl::OptionCategory DebugCat("Internal and debugging options");
 static cl::opt<bool> DumpGCOV("dump", cl::init(false), cl::cat(DebugCat),
                               cl::desc("Dump the gcov file to stderr"));
@@ -75,14 +85,39 @@ static cl::opt<std::string> InputGCNO("gcno", cl::cat(DebugCat), cl::init(""),
 static cl::opt<std::string> InputGCDA("gcda", cl::cat(DebugCat), cl::init(""),
                                       cl::desc("Override inferred gcda file"));
 
-//===----------------------------------------------------------------------===//
-int main(int argc, char **argv) {
-  // Print a stack trace if we signal out.
-  sys::PrintStackTraceOnErrorSignal();
-  PrettyStackTraceProgram X(argc, argv);
-  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+namespace {
+/// The output of processing one source file, kept until it can be written in
+/// command line order.
+struct SourceResult {
+  SourceResult() : Failed(false) {}
+
+  bool Failed;
+  /// What llvm-cov prints for the file on stdout and stderr.
+  std::string Info;
+  std::string Errors;
+  /// The .gcov files to write.
+  std::vector<FileInfo::CoverageReport> Reports;
+};
+}
 
-  cl::ParseCommandLineOptions(argc, argv, "LLVM code coverage tool\n");
+/// readCoverageFile - Read a .gcno or .gcda file. The buffer is only read, so
+/// let large files be mapped rather than copied into memory.
+static std::error_code readCoverageFile(StringRef Path,
+                                        std::unique_ptr<MemoryBuffer> &Buff) {
+  if (Path == "-")
+    return MemoryBuffer::getSTDIN(Buff);
+  return MemoryBuffer::getFile(Path, Buff, -1,
+                               /*RequiresNullTerminator=*/false);
+}
+
+/// processSource - Read the coverage data of \p SourceFile and render its
+/// reports.  The .gcov files are only written by the caller when
+/// \p KeepReports is set.
+static void processSource(const std::string &SourceFile,
+                          const GCOVOptions &Options, bool KeepReports,
+                          SourceResult &Result) {
+  raw_string_ostream InfoOS(Result.Info);
+  raw_string_ostream ErrOS(Result.Errors);
 
   SmallString<128> CoverageFileStem(ObjectDir);
   if (CoverageFileStem.empty()) {
@@ -96,47 +131,119 @@ int main(int argc, char **argv) {
     // A file was given. Ignore the source file and look next to this file.
     sys::path::replace_extension(CoverageFileStem, "");
 
-  if (InputGCNO.empty())
-    InputGCNO = (CoverageFileStem.str() + ".gcno").str();
-  if (InputGCDA.empty())
-    InputGCDA = (CoverageFileStem.str() + ".gcda").str();
+  std::string GCNOPath = InputGCNO;
+  std::string GCDAPath = InputGCDA;
+  if (GCNOPath.empty())
+    GCNOPath = (CoverageFileStem.str() + ".gcno").str();
+  if (GCDAPath.empty())
+    GCDAPath = (CoverageFileStem.str() + ".gcda").str();
 
   GCOVFile GF;
 
   std::unique_ptr<MemoryBuffer> GCNO_Buff;
-  if (std::error_code ec = MemoryBuffer::getFileOrSTDIN(InputGCNO, GCNO_Buff)) {
-    errs() << InputGCNO << ": " << ec.message() << "\n";
-    return 1;
+  if (std::error_code ec = readCoverageFile(GCNOPath, GCNO_Buff)) {
+    ErrOS << GCNOPath << ": " << ec.message() << "\n";
+    Result.Failed = true;
+    return;
   }
   GCOVBuffer GCNO_GB(GCNO_Buff.get());
   if (!GF.readGCNO(GCNO_GB)) {
-    errs() << "Invalid .gcno File!\n";
-    return 1;
+    ErrOS << "Invalid .gcno File!\n";
+    Result.Failed = true;
+    return;
   }
 
   std::unique_ptr<MemoryBuffer> GCDA_Buff;
-  if (std::error_code ec = MemoryBuffer::getFileOrSTDIN(InputGCDA, GCDA_Buff)) {
+  if (std::error_code ec = readCoverageFile(GCDAPath, GCDA_Buff)) {
     if (ec != std::errc::no_such_file_or_directory) {
-      errs() << InputGCDA << ": " << ec.message() << "\n";
-      return 1;
+      ErrOS << GCDAPath << ": " << ec.message() << "\n";
+      Result.Failed = true;
+      return;
     }
     // Clear the filename to make it clear we didn't read anything.
-    InputGCDA = "-";
+    GCDAPath = "-";
   } else {
     GCOVBuffer GCDA_GB(GCDA_Buff.get());
     if (!GF.readGCDA(GCDA_GB)) {
-      errs() << "Invalid .gcda File!\n";
-      return 1;
+      ErrOS << "Invalid .gcda File!\n";
+      Result.Failed = true;
+      return;
     }
   }
 
   if (DumpGCOV)
     GF.dump();
 
-  GCOVOptions Options(AllBlocks, BranchProb, BranchCount, FuncSummary,
-                      PreservePaths, UncondBranch, LongNames, NoOutput);
   FileInfo FI(Options);
+  if (KeepReports)
+    FI.keepReports();
   GF.collectLineCounts(FI);
-  FI.print(SourceFile, InputGCNO, InputGCDA);
-  return 0;
+  FI.print(InfoOS, SourceFile, GCNOPath, GCDAPath);
+  Result.Reports = std::move(FI.getReports());
+}
+
+//===----------------------------------------------------------------------===//
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  cl::ParseCommandLineOptions(argc, argv, "LLVM code coverage tool\n");
+
+  if (SourceFiles.size() > 1 && (!InputGCNO.empty() || !InputGCDA.empty())) {
+    errs() << "-gcno and -gcda can only be used with a single source file\n";
+    return 1;
+  }
+
+  GCOVOptions Options(AllBlocks, BranchProb, BranchCount, FuncSummary,
+                      PreservePaths, UncondBranch, LongNames, NoOutput);
+
+  // Source files are independent of each other, except that two of them may
+  // produce a report for the same header; gcov then keeps the report of the
+  // later one.  Process a window of files at a time on several threads and
+  // write out their reports and summaries in command line order.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = ThreadPool::getThreadCount();
+  if (DumpGCOV)
+    Threads = 1;
+  Threads = std::max(1u, std::min<unsigned>(Threads, SourceFiles.size()));
+
+  bool Failed = false;
+  FileInfo Writer(Options);
+  auto Emit = [&](const SourceResult &Result) {
+    for (const FileInfo::CoverageReport &Report : Result.Reports)
+      Writer.writeReport(Report);
+    outs() << Result.Info;
+    errs() << Result.Errors;
+    Failed |= Result.Failed;
+  };
+
+  if (Threads == 1) {
+    for (const std::string &SourceFile : SourceFiles) {
+      SourceResult Result;
+      processSource(SourceFile, Options, /*KeepReports=*/false, Result);
+      Emit(Result);
+    }
+    return Failed ? 1 : 0;
+  }
+
+  ThreadPool Pool(Threads);
+  size_t Window = Threads * 16;
+  for (size_t WBegin = 0, WEnd; WBegin < SourceFiles.size(); WBegin = WEnd) {
+    WEnd = std::min(SourceFiles.size(), WBegin + Window);
+    std::vector<SourceResult> Results(WEnd - WBegin);
+    for (size_t I = WBegin; I != WEnd; ++I) {
+      const GCOVOptions *Opts = &Options;
+      SourceResult *Result = &Results[I - WBegin];
+      Pool.async([I, Opts, Result] {
+        processSource(SourceFiles[I], *Opts, /*KeepReports=*/true, *Result);
+      });
+    }
+    Pool.wait();
+    for (const SourceResult &Result : Results)
+      Emit(Result);
+  }
+  return Failed ? 1 : 0;
 }
@@ -56,6 +56,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
@@ -146,6 +147,17 @@ YAMLCFG("yaml-cfg",
         cl::desc("Create a CFG and write it as a YAML MCModule."),
         cl::value_desc("yaml output file"));
 
+static cl::opt<unsigned>
+NumThreads("num-threads", cl::init(0),
+           cl::desc("Number of threads used to disassemble large sections "
+                    "(default: autodetect)"));
+
+static cl::opt<unsigned>
+ParallelSectionSize("parallel-disassembly-threshold", cl::Hidden,
+                    cl::init(64 * 1024),
+                    cl::desc("Size in bytes from which a section is "
+                             "disassembled on several threads"));
+
 static StringRef ToolName;
 
 bool llvm::error(std::error_code EC) {
@@ -239,6 +251,10 @@ static void emitDOTFile(const char *FileName, const MCFunction &f,
 }
 
 void llvm::DumpBytes(StringRef bytes) {
+  DumpBytes(bytes, outs());
+}
+
+void llvm::DumpBytes(StringRef bytes, raw_ostream &OS) {
   static const char hex_rep[] = "0123456789abcdef";
   // FIXME: The real way to do this is to figure out the longest instruction
   //        and align to that size before printing. I'll fix this when I get
@@ -261,7 +277,7 @@ void llvm::DumpBytes(StringRef bytes) {
   }
 
   output[sizeof(output) - 1] = 0;
-  outs() << output;
+  OS << output;
 }
 
 bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
@@ -271,6 +287,118 @@ bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
   return a_addr < b_addr;
 }
 
+namespace {
+/// The state one thread needs to disassemble and print instructions.
+struct DisassemblerContext {
+  std::unique_ptr<const MCObjectFileInfo> MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+};
+
+/// A symbol whose address and name have already been looked up.
+struct IndexedSymbol {
+  SymbolRef Symbol;
+  uint64_t Address;
+  StringRef Name;
+};
+
+/// The instructions between two symbols of a section, printed into a string
+/// so that ranges disassembled on different threads can be output in order.
+struct DisassembledRange {
+  struct Inst {
+    uint64_t Index;
+    uint64_t Size;
+    size_t TextEnd;
+    bool Valid;
+  };
+
+  StringRef Name;
+  uint64_t Start;
+  uint64_t End;
+  std::string Text;
+  std::vector<Inst> Insts;
+};
+}
+
+static bool createDisassemblerContext(const Target *TheTarget,
+                                      const ObjectFile *Obj,
+                                      const MCAsmInfo &AsmInfo,
+                                      const MCRegisterInfo &MRI,
+                                      const MCSubtargetInfo &STI,
+                                      const MCInstrInfo &MII,
+                                      DisassemblerContext &DC) {
+  DC.MOFI.reset(new MCObjectFileInfo);
+  DC.Ctx.reset(new MCContext(&AsmInfo, &MRI, DC.MOFI.get()));
+
+  DC.DisAsm.reset(TheTarget->createMCDisassembler(STI, *DC.Ctx));
+  if (!DC.DisAsm) {
+    errs() << "error: no disassembler for target " << TripleName << "\n";
+    return false;
+  }
+
+  if (Symbolize) {
+    std::unique_ptr<MCRelocationInfo> RelInfo(
+        TheTarget->createMCRelocationInfo(TripleName, *DC.Ctx));
+    if (RelInfo) {
+      std::unique_ptr<MCSymbolizer> Symzer(
+        MCObjectSymbolizer::createObjectSymbolizer(*DC.Ctx, std::move(RelInfo),
+                                                   Obj));
+      if (Symzer)
+        DC.DisAsm->setSymbolizer(std::move(Symzer));
+    }
+  }
+
+  int AsmPrinterVariant = AsmInfo.getAssemblerDialect();
+  DC.IP.reset(TheTarget->createMCInstPrinter(AsmPrinterVariant, AsmInfo, MII,
+                                             MRI, STI));
+  if (!DC.IP) {
+    errs() << "error: no instruction printer for target " << TripleName
+      << '\n';
+    return false;
+  }
+  return true;
+}
+
+/// Disassemble the instructions of \p R into R.Text.
+static void disassembleRange(DisassemblerContext &DC, StringRef Bytes,
+                             uint64_t SectionAddr, raw_ostream &DebugOut,
+                             DisassembledRange &R) {
+  SmallString<40> Comments;
+  raw_svector_ostream CommentStream(Comments);
+  raw_string_ostream OS(R.Text);
+  StringRefMemoryObject memoryObject(Bytes, SectionAddr);
+  uint64_t Size;
+
+  for (uint64_t Index = R.Start; Index < R.End; Index += Size) {
+    MCInst Inst;
+    DisassembledRange::Inst I;
+
+    I.Valid = DC.DisAsm->getInstruction(Inst, Size, memoryObject,
+                                        SectionAddr + Index, DebugOut,
+                                        CommentStream);
+    if (I.Valid) {
+      OS << format("%8" PRIx64 ":", SectionAddr + Index);
+      if (!NoShowRawInsn) {
+        OS << "\t";
+        DumpBytes(StringRef(Bytes.data() + Index, Size), OS);
+      }
+      DC.IP->printInst(&Inst, OS, "");
+      OS << CommentStream.str();
+      Comments.clear();
+      OS << "\n";
+    } else if (Size == 0) {
+      Size = 1; // skip illegible bytes
+    }
+
+    I.Index = Index;
+    I.Size = Size;
+    I.TextEnd = OS.tell();
+    R.Insts.push_back(I);
+  }
+  OS.flush();
+}
+
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   const Target *TheTarget = getTarget(Obj);
   // getTarget() will have already issued a diagnostic if necessary, so
@@ -315,42 +443,22 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     return;
   }
 
-  std::unique_ptr<const MCObjectFileInfo> MOFI(new MCObjectFileInfo);
-  MCContext Ctx(AsmInfo.get(), MRI.get(), MOFI.get());
-
-  std::unique_ptr<MCDisassembler> DisAsm(
-    TheTarget->createMCDisassembler(*STI, Ctx));
-
-  if (!DisAsm) {
-    errs() << "error: no disassembler for target " << TripleName << "\n";
-    return;
-  }
-
-
-  if (Symbolize) {
-    std::unique_ptr<MCRelocationInfo> RelInfo(
-        TheTarget->createMCRelocationInfo(TripleName, Ctx));
-    if (RelInfo) {
-      std::unique_ptr<MCSymbolizer> Symzer(
-        MCObjectSymbolizer::createObjectSymbolizer(Ctx, std::move(RelInfo),
-                                                   Obj));
-      if (Symzer)
-        DisAsm->setSymbolizer(std::move(Symzer));
-    }
-  }
+  // Every thread needs its own disassembler, printer and the context they
+  // use; the target descriptions above are only read and can be shared.
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = ThreadPool::getThreadCount();
+  std::vector<DisassemblerContext> Contexts(Threads);
+  for (DisassemblerContext &DC : Contexts)
+    if (!createDisassemblerContext(TheTarget, Obj, *AsmInfo, *MRI, *STI, *MII,
+                                   DC))
+      return;
+  MCDisassembler *DisAsm = Contexts[0].DisAsm.get();
+  MCInstPrinter *IP = Contexts[0].IP.get();
 
   std::unique_ptr<const MCInstrAnalysis> MIA(
       TheTarget->createMCInstrAnalysis(MII.get()));
 
-  int AsmPrinterVariant = AsmInfo->getAssemblerDialect();
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      AsmPrinterVariant, *AsmInfo, *MII, *MRI, *STI));
-  if (!IP) {
-    errs() << "error: no instruction printer for target " << TripleName
-      << '\n';
-    return;
-  }
-
   if (CFG || !YAMLCFG.empty()) {
     std::unique_ptr<MCObjectDisassembler> OD(
         new MCObjectDisassembler(*Obj, *DisAsm, *MIA));
@@ -375,7 +483,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         static int filenum = 0;
         emitDOTFile((Twine((*FI)->getName()) + "_" +
                      utostr(filenum) + ".dot").str().c_str(),
-                      **FI, IP.get());
+                      **FI, IP);
         ++filenum;
       }
     }
@@ -403,6 +511,23 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
       SectionRelocMap[*Sec2].push_back(Section);
   }
 
+  // Look up the address and name of every symbol once, rather than once for
+  // each section.
+  std::vector<IndexedSymbol> AllSymbols;
+  for (const SymbolRef &Symbol : Obj->symbols()) {
+    IndexedSymbol S = { Symbol, 0, StringRef() };
+    if (error(Symbol.getAddress(S.Address)))
+      continue;
+    if (S.Address == UnknownAddressOrSize)
+      continue;
+    if (error(Symbol.getName(S.Name)))
+      continue;
+    AllSymbols.push_back(S);
+  }
+
+  // Started by the first section large enough to be split between threads.
+  std::unique_ptr<ThreadPool> Pool;
+
   for (const SectionRef &Section : Obj->sections()) {
     bool Text;
     if (error(Section.isText(Text)))
@@ -420,22 +545,13 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
     // Make a list of all the symbols in this section.
     std::vector<std::pair<uint64_t, StringRef>> Symbols;
-    for (const SymbolRef &Symbol : Obj->symbols()) {
+    for (const IndexedSymbol &S : AllSymbols) {
       bool contains;
-      if (!error(Section.containsSymbol(Symbol, contains)) && contains) {
-        uint64_t Address;
-        if (error(Symbol.getAddress(Address)))
-          break;
-        if (Address == UnknownAddressOrSize)
-          continue;
-        Address -= SectionAddr;
+      if (!error(Section.containsSymbol(S.Symbol, contains)) && contains) {
+        uint64_t Address = S.Address - SectionAddr;
         if (Address >= SectSize)
           continue;
-
-        StringRef Name;
-        if (error(Symbol.getName(Name)))
-          break;
-        Symbols.push_back(std::make_pair(Address, Name));
+        Symbols.push_back(std::make_pair(Address, S.Name));
       }
     }
 
@@ -473,86 +589,114 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     if (Symbols.empty())
       Symbols.push_back(std::make_pair(0, name));
 
-
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef Bytes;
     if (error(Section.getContents(Bytes)))
       break;
-    StringRefMemoryObject memoryObject(Bytes, SectionAddr);
-    uint64_t Size;
-    uint64_t Index;
 
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
+    // Split the section at its symbols.
+    std::vector<DisassembledRange> Ranges;
     for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-      uint64_t Start = Symbols[si].first;
-      uint64_t End;
+      DisassembledRange R;
+      R.Name = Symbols[si].second;
+      R.Start = Symbols[si].first;
       // The end is either the size of the section or the beginning of the next
       // symbol.
       if (si == se - 1)
-        End = SectSize;
+        R.End = SectSize;
       // Make sure this symbol takes up space.
-      else if (Symbols[si + 1].first != Start)
-        End = Symbols[si + 1].first - 1;
+      else if (Symbols[si + 1].first != R.Start)
+        R.End = Symbols[si + 1].first - 1;
       else
         // This symbol has the same address as the next symbol. Skip it.
         continue;
+      Ranges.push_back(R);
+    }
 
-      outs() << '\n' << Symbols[si].second << ":\n";
-
+    // Disassemble a window of ranges at a time, on several threads if the
+    // section is large enough to be worth it, and print them in address
+    // order.  Relocations are printed while stitching, as which instruction
+    // a relocation follows depends on everything disassembled before it.
+    bool Parallel = Threads > 1 && SectSize >= ParallelSectionSize;
+    if (Parallel && !Pool)
+      Pool.reset(new ThreadPool(Threads));
+    size_t Window = Parallel ? Threads * 64 : 1;
+    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
+    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
 #ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+    raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
 #else
-      raw_ostream &DebugOut = nulls();
+    raw_ostream &DebugOut = nulls();
 #endif
+    for (size_t WBegin = 0, WEnd; WBegin < Ranges.size(); WBegin = WEnd) {
+      WEnd = std::min(Ranges.size(), WBegin + Window);
+      if (!Parallel) {
+        // Print the symbol before disassembling, so that it is not lost if the
+        // disassembler reports a fatal error.
+        for (size_t I = WBegin; I != WEnd; ++I) {
+          outs() << '\n' << Ranges[I].Name << ":\n";
+          disassembleRange(Contexts[0], Bytes, SectionAddr, DebugOut,
+                           Ranges[I]);
+        }
+      } else {
+        DisassembledRange *WRanges = &Ranges[WBegin];
+        size_t Count = WEnd - WBegin;
+        for (unsigned T = 0; T < Threads; ++T) {
+          size_t Begin = Count * T / Threads;
+          size_t End = Count * (T + 1) / Threads;
+          DisassemblerContext *DC = &Contexts[T];
+          Pool->async([=] {
+            raw_null_ostream NoDebugOut;
+            for (size_t I = Begin; I != End; ++I)
+              disassembleRange(*DC, Bytes, SectionAddr, NoDebugOut,
+                               WRanges[I]);
+          });
+        }
+        Pool->wait();
+      }
 
-      for (Index = Start; Index < End; Index += Size) {
-        MCInst Inst;
-
-        if (DisAsm->getInstruction(Inst, Size, memoryObject,
-                                   SectionAddr + Index,
-                                   DebugOut, CommentStream)) {
-          outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-          if (!NoShowRawInsn) {
-            outs() << "\t";
-            DumpBytes(StringRef(Bytes.data() + Index, Size));
+      for (size_t I = WBegin; I != WEnd; ++I) {
+        DisassembledRange &R = Ranges[I];
+        if (Parallel)
+          outs() << '\n' << R.Name << ":\n";
+
+        size_t TextBegin = 0;
+        for (const DisassembledRange::Inst &In : R.Insts) {
+          if (In.Valid)
+            outs() << StringRef(R.Text).slice(TextBegin, In.TextEnd);
+          else
+            errs() << ToolName << ": warning: invalid instruction encoding\n";
+          TextBegin = In.TextEnd;
+
+          // Print relocation for instruction.
+          while (rel_cur != rel_end) {
+            bool hidden = false;
+            uint64_t addr;
+            SmallString<16> name;
+            SmallString<32> val;
+
+            // If this relocation is hidden, skip it.
+            if (error(rel_cur->getHidden(hidden))) goto skip_print_rel;
+            if (hidden) goto skip_print_rel;
+
+            if (error(rel_cur->getOffset(addr))) goto skip_print_rel;
+            // Stop when rel_cur's address is past the current instruction.
+            if (addr >= In.Index + In.Size) break;
+            if (error(rel_cur->getTypeName(name))) goto skip_print_rel;
+            if (error(rel_cur->getValueString(val))) goto skip_print_rel;
+
+            outs() << format(Fmt.data(), SectionAddr + addr) << name
+                   << "\t" << val << "\n";
+
+          skip_print_rel:
+            ++rel_cur;
           }
-          IP->printInst(&Inst, outs(), "");
-          outs() << CommentStream.str();
-          Comments.clear();
-          outs() << "\n";
-        } else {
-          errs() << ToolName << ": warning: invalid instruction encoding\n";
-          if (Size == 0)
-            Size = 1; // skip illegible bytes
         }
 
-        // Print relocation for instruction.
-        while (rel_cur != rel_end) {
-          bool hidden = false;
-          uint64_t addr;
-          SmallString<16> name;
-          SmallString<32> val;
-
-          // If this relocation is hidden, skip it.
-          if (error(rel_cur->getHidden(hidden))) goto skip_print_rel;
-          if (hidden) goto skip_print_rel;
-
-          if (error(rel_cur->getOffset(addr))) goto skip_print_rel;
-          // Stop when rel_cur's address is past the current instruction.
-          if (addr >= Index + Size) break;
-          if (error(rel_cur->getTypeName(name))) goto skip_print_rel;
-          if (error(rel_cur->getValueString(val))) goto skip_print_rel;
-
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
-                 << "\t" << val << "\n";
-
-        skip_print_rel:
-          ++rel_cur;
-        }
+        // Release the text as soon as it has been printed.
+        R.Text.clear();
+        R.Text.shrink_to_fit();
+        R.Insts.clear();
+        R.Insts.shrink_to_fit();
       }
     }
   }
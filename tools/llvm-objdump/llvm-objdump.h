@@ -16,6 +16,8 @@
 #include "llvm/Support/StringRefMemoryObject.h"
 
 namespace llvm {
+class raw_ostream;
+
 namespace object {
   class COFFObjectFile;
   class ObjectFile;
@@ -29,6 +31,7 @@ extern cl::opt<std::string> ArchName;
 bool error(std::error_code ec);
 bool RelocAddressLess(object::RelocationRef a, object::RelocationRef b);
 void DumpBytes(StringRef bytes);
+void DumpBytes(StringRef bytes, raw_ostream &OS);
 void DisassembleInputMachO(StringRef Filename);
 void printCOFFUnwindInfo(const object::COFFObjectFile* o);
 void printELFFileHeader(const object::ObjectFile *o);
@@ -21,6 +21,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -33,6 +34,40 @@ static void exitWithError(const Twine &Message, StringRef Whence = "") {
   ::exit(1);
 }
 
+namespace {
+/// The state of one merge thread: the counts of a contiguous slice of the
+/// inputs and the diagnostics produced while reading them. Diagnostics are
+/// buffered so that they are printed in input order.
+struct WriterContext {
+  InstrProfWriter Writer;
+  std::string Warnings;
+  std::error_code Error;
+  std::string ErrorWhence;
+};
+}
+
+static void loadInputs(ArrayRef<std::string> Filenames, WriterContext &Ctx) {
+  raw_string_ostream Warnings(Ctx.Warnings);
+  for (const auto &Filename : Filenames) {
+    std::unique_ptr<InstrProfReader> Reader;
+    if (std::error_code EC = InstrProfReader::create(Filename, Reader)) {
+      Ctx.Error = EC;
+      Ctx.ErrorWhence = Filename;
+      return;
+    }
+
+    for (const auto &I : *Reader)
+      if (std::error_code EC =
+              Ctx.Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
+        Warnings << Filename << ": " << I.Name << ": " << EC.message() << "\n";
+    if (Reader->hasError()) {
+      Ctx.Error = Reader->getError();
+      Ctx.ErrorWhence = Filename;
+      return;
+    }
+  }
+}
+
 int merge_main(int argc, const char *argv[]) {
   cl::list<std::string> Inputs(cl::Positional, cl::Required, cl::OneOrMore,
                                cl::desc("<filenames...>"));
@@ -43,6 +78,16 @@ int merge_main(int argc, const char *argv[]) {
   cl::alias OutputFilenameA("o", cl::desc("Alias for --output"), cl::Required,
                             cl::aliasopt(OutputFilename));
 
+  cl::opt<unsigned> NumThreads(
+      "num-threads", cl::init(0),
+      cl::desc("Number of merge threads to use (default: autodetect)"));
+  cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
+                        cl::aliasopt(NumThreads));
+
+  cl::opt<unsigned long long> MinFunctionCount(
+      "min-function-count", cl::init(0),
+      cl::desc("Drop functions whose entry count is below this threshold"));
+
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
   if (OutputFilename.compare("-") == 0)
@@ -53,19 +98,45 @@ int merge_main(int argc, const char *argv[]) {
   if (!ErrorInfo.empty())
     exitWithError(ErrorInfo, OutputFilename);
 
-  InstrProfWriter Writer;
-  for (const auto &Filename : Inputs) {
-    std::unique_ptr<InstrProfReader> Reader;
-    if (std::error_code ec = InstrProfReader::create(Filename, Reader))
-      exitWithError(ec.message(), Filename);
+  // Give each thread at least two inputs, so that merging the per-thread
+  // results does not dominate.
+  if (NumThreads == 0)
+    NumThreads = std::min<unsigned>(ThreadPool::getThreadCount(),
+                                    (Inputs.size() + 1) / 2);
+  NumThreads = std::max(1u, std::min<unsigned>(NumThreads, Inputs.size()));
+
+  // Each context reads a contiguous slice of the inputs. Merging the contexts
+  // in order then gives the same result as reading the inputs one by one.
+  std::vector<WriterContext> Contexts(NumThreads);
+  ArrayRef<std::string> Filenames(Inputs);
+  if (NumThreads == 1) {
+    loadInputs(Filenames, Contexts[0]);
+  } else {
+    ThreadPool Pool(NumThreads);
+    for (unsigned I = 0; I < NumThreads; ++I) {
+      size_t Begin = Filenames.size() * I / NumThreads;
+      size_t End = Filenames.size() * (I + 1) / NumThreads;
+      WriterContext *Ctx = &Contexts[I];
+      ArrayRef<std::string> Slice = Filenames.slice(Begin, End - Begin);
+      Pool.async([Slice, Ctx] { loadInputs(Slice, *Ctx); });
+    }
+    Pool.wait();
+  }
 
-    for (const auto &I : *Reader)
-      if (std::error_code EC =
-              Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
-        errs() << Filename << ": " << I.Name << ": " << EC.message() << "\n";
-    if (Reader->hasError())
-      exitWithError(Reader->getError().message(), Filename);
+  InstrProfWriter &Writer = Contexts[0].Writer;
+  for (auto &Ctx : Contexts) {
+    errs() << Ctx.Warnings;
+    if (Ctx.Error)
+      exitWithError(Ctx.Error.message(), Ctx.ErrorWhence);
+    if (&Ctx.Writer != &Writer)
+      Writer.mergeRecordsFromWriter(
+          Ctx.Writer, [](StringRef Name, std::error_code EC) {
+            errs() << Name << ": " << EC.message() << "\n";
+          });
   }
+
+  if (MinFunctionCount)
+    Writer.removeColdFunctions(MinFunctionCount);
   Writer.write(Output);
 
   return 0;
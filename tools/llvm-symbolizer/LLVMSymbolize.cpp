@@ -13,6 +13,7 @@
 
 #include "LLVMSymbolize.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Config/config.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
@@ -22,6 +23,8 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <stdlib.h>
 
@@ -42,23 +45,25 @@ getDILineInfoSpecifier(const LLVMSymbolizer::Options &Opts) {
       Opts.PrintFunctions);
 }
 
-ModuleInfo::ModuleInfo(ObjectFile *Obj, DIContext *DICtx)
-    : Module(Obj), DebugInfoContext(DICtx) {
-  for (const SymbolRef &Symbol : Module->symbols()) {
-    addSymbol(Symbol);
-  }
-  bool NoSymbolTable = (Module->symbol_begin() == Module->symbol_end());
-  if (NoSymbolTable && Module->isELF()) {
-    // Fallback to dynamic symbol table, if regular symbol table is stripped.
-    std::pair<symbol_iterator, symbol_iterator> IDyn =
-        getELFDynamicSymbolIterators(Module);
-    for (symbol_iterator si = IDyn.first, se = IDyn.second; si != se; ++si) {
-      addSymbol(*si);
-    }
-  }
+namespace {
+struct SymbolDesc {
+  uint64_t Addr;
+  uint64_t Size;
+  StringRef Name;
+};
+}
+
+static bool compareSymbolAddr(const SymbolDesc &S1, const SymbolDesc &S2) {
+  return S1.Addr < S2.Addr;
 }
 
-void ModuleInfo::addSymbol(const SymbolRef &Symbol) {
+static bool equalSymbolAddr(const SymbolDesc &S1, const SymbolDesc &S2) {
+  return S1.Addr == S2.Addr;
+}
+
+static void addSymbol(const ObjectFile *Module, const SymbolRef &Symbol,
+                      std::vector<SymbolDesc> &Functions,
+                      std::vector<SymbolDesc> &Objects) {
   SymbolRef::Type SymbolType;
   if (error(Symbol.getType(SymbolType)))
     return;
@@ -82,29 +87,176 @@ void ModuleInfo::addSymbol(const SymbolRef &Symbol) {
   // Mach-O symbol table names have leading underscore, skip it.
   if (Module->isMachO() && SymbolName.size() > 0 && SymbolName[0] == '_')
     SymbolName = SymbolName.drop_front();
-  // FIXME: If a function has alias, there are two entries in symbol table
-  // with same address size. Make sure we choose the correct one.
-  SymbolMapTy &M = SymbolType == SymbolRef::ST_Function ? Functions : Objects;
-  SymbolDesc SD = { SymbolAddress, SymbolSize };
-  M.insert(std::make_pair(SD, SymbolName));
+  SymbolDesc SD = { SymbolAddress, SymbolSize, SymbolName };
+  if (SymbolType == SymbolRef::ST_Function)
+    Functions.push_back(SD);
+  else
+    Objects.push_back(SD);
+}
+
+// Sorts symbols by address. Only the first symbol seen at each address is
+// kept.
+// FIXME: If a function has alias, there are two entries in symbol table
+// with same address size. Make sure we choose the correct one.
+static void sortSymbols(std::vector<SymbolDesc> &Symbols) {
+  std::stable_sort(Symbols.begin(), Symbols.end(), compareSymbolAddr);
+  Symbols.erase(std::unique(Symbols.begin(), Symbols.end(), equalSymbolAddr),
+                Symbols.end());
+}
+
+const char SymbolIndex::kMagic[8] = { 'L', 'L', 'V', 'M', 'S', 'Y', 'M', 'X' };
+
+SymbolIndex *SymbolIndex::create(ObjectFile *Obj) {
+  std::vector<SymbolDesc> Functions;
+  std::vector<SymbolDesc> Objects;
+  for (const SymbolRef &Symbol : Obj->symbols())
+    addSymbol(Obj, Symbol, Functions, Objects);
+  bool NoSymbolTable = (Obj->symbol_begin() == Obj->symbol_end());
+  if (NoSymbolTable && Obj->isELF()) {
+    // Fallback to dynamic symbol table, if regular symbol table is stripped.
+    std::pair<symbol_iterator, symbol_iterator> IDyn =
+        getELFDynamicSymbolIterators(Obj);
+    for (symbol_iterator si = IDyn.first, se = IDyn.second; si != se; ++si)
+      addSymbol(Obj, *si, Functions, Objects);
+  }
+  sortSymbols(Functions);
+  sortSymbols(Objects);
+
+  uint64_t StringTableSize = 0;
+  for (const SymbolDesc &SD : Functions)
+    StringTableSize += SD.Name.size();
+  for (const SymbolDesc &SD : Objects)
+    StringTableSize += SD.Name.size();
+  // Name offsets are 32-bit. Drop the names rather than produce a corrupt
+  // index for (implausibly) huge symbol tables.
+  bool KeepNames = StringTableSize <= UINT32_MAX;
+  if (!KeepNames)
+    StringTableSize = 0;
+
+  size_t NumEntries = Functions.size() + Objects.size();
+  size_t BufferSize =
+      sizeof(Header) + NumEntries * sizeof(Entry) + StringTableSize;
+  MemoryBuffer *Buffer =
+      MemoryBuffer::getNewMemBuffer(BufferSize, Obj->getFileName());
+  char *Ptr = const_cast<char *>(Buffer->getBufferStart());
+
+  Header *H = reinterpret_cast<Header *>(Ptr);
+  memcpy(H->Magic, kMagic, sizeof(kMagic));
+  H->Version = kVersion;
+  H->NumFunctions = Functions.size();
+  H->NumObjects = Objects.size();
+  H->StringTableSize = StringTableSize;
+
+  Entry *E = reinterpret_cast<Entry *>(Ptr + sizeof(Header));
+  char *StringTable = Ptr + sizeof(Header) + NumEntries * sizeof(Entry);
+  uint32_t NameOffset = 0;
+  auto EmitEntry = [&](const SymbolDesc &SD) {
+    E->Addr = SD.Addr;
+    E->Size = SD.Size;
+    E->NameOffset = NameOffset;
+    E->NameSize = KeepNames ? SD.Name.size() : 0;
+    if (KeepNames) {
+      memcpy(StringTable + NameOffset, SD.Name.data(), SD.Name.size());
+      NameOffset += SD.Name.size();
+    }
+    ++E;
+  };
+  std::for_each(Functions.begin(), Functions.end(), EmitEntry);
+  std::for_each(Objects.begin(), Objects.end(), EmitEntry);
+
+  SymbolIndex *Index = new SymbolIndex(Buffer);
+  bool Valid = Index->parse();
+  assert(Valid && "Freshly built symbol index must be valid");
+  (void)Valid;
+  return Index;
 }
 
+SymbolIndex *SymbolIndex::load(StringRef Path) {
+  std::unique_ptr<MemoryBuffer> Buffer;
+  // The index is used in place, so let large files be memory-mapped.
+  if (MemoryBuffer::getFile(Path, Buffer, -1,
+                            /*RequiresNullTerminator=*/false))
+    return nullptr;
+  std::unique_ptr<SymbolIndex> Index(new SymbolIndex(Buffer.release()));
+  if (!Index->parse())
+    return nullptr;
+  return Index.release();
+}
+
+bool SymbolIndex::parse() {
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < sizeof(Header))
+    return false;
+  const Header *H = reinterpret_cast<const Header *>(Data.data());
+  if (memcmp(H->Magic, kMagic, sizeof(kMagic)) != 0 || H->Version != kVersion)
+    return false;
+  uint64_t NumEntries = uint64_t(H->NumFunctions) + H->NumObjects;
+  uint64_t EntriesSize = NumEntries * sizeof(Entry);
+  if (Data.size() != sizeof(Header) + EntriesSize + H->StringTableSize)
+    return false;
+  // Entries only contain unaligned little-endian fields, so they can be read
+  // directly from the buffer whatever its alignment.
+  const Entry *Entries =
+      reinterpret_cast<const Entry *>(Data.data() + sizeof(Header));
+  Functions = ArrayRef<Entry>(Entries, H->NumFunctions);
+  Objects = ArrayRef<Entry>(Entries + H->NumFunctions, H->NumObjects);
+  Strings = Data.substr(sizeof(Header) + EntriesSize);
+  return true;
+}
+
+std::error_code SymbolIndex::writeToFile(StringRef Path) const {
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC =
+          sys::fs::createUniqueFile(Path + "-%%%%%%%%.tmp", FD, TempPath))
+    return EC;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Buffer->getBuffer();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath.str());
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (std::error_code EC = sys::fs::rename(TempPath.str(), Path)) {
+    sys::fs::remove(TempPath.str());
+    return EC;
+  }
+  return std::error_code();
+}
+
+bool SymbolIndex::lookup(SymbolRef::Type Type, uint64_t Address,
+                         StringRef &Name, uint64_t &Addr,
+                         uint64_t &Size) const {
+  ArrayRef<Entry> Entries = Type == SymbolRef::ST_Function ? Functions : Objects;
+  const Entry *It = std::upper_bound(
+      Entries.begin(), Entries.end(), Address,
+      [](uint64_t A, const Entry &E) { return A < E.Addr; });
+  if (It == Entries.begin())
+    return false;
+  --It;
+  if (It->Size != 0 && It->Addr + It->Size <= Address)
+    return false;
+  // substr() clamps out-of-range offsets, so a damaged index on disk can only
+  // produce a wrong name, never an out-of-bounds read.
+  Name = Strings.substr(It->NameOffset, It->NameSize);
+  Addr = It->Addr;
+  Size = It->Size;
+  return true;
+}
+
+ModuleInfo::ModuleInfo(ObjectFile *Obj, DIContext *DICtx, SymbolIndex *Symbols)
+    : Module(Obj), DebugInfoContext(DICtx), Symbols(Symbols) {}
+
 bool ModuleInfo::getNameFromSymbolTable(SymbolRef::Type Type, uint64_t Address,
                                         std::string &Name, uint64_t &Addr,
                                         uint64_t &Size) const {
-  const SymbolMapTy &M = Type == SymbolRef::ST_Function ? Functions : Objects;
-  if (M.empty())
-    return false;
-  SymbolDesc SD = { Address, Address };
-  SymbolMapTy::const_iterator it = M.upper_bound(SD);
-  if (it == M.begin())
-    return false;
-  --it;
-  if (it->first.Size != 0 && it->first.Addr + it->first.Size <= Address)
+  StringRef SymbolName;
+  if (!Symbols->lookup(Type, Address, SymbolName, Addr, Size))
     return false;
-  Name = it->second.str();
-  Addr = it->first.Addr;
-  Size = it->first.Size;
+  Name = SymbolName.str();
   return true;
 }
 
@@ -360,6 +512,58 @@ LLVMSymbolizer::getObjectFileFromBinary(Binary *Bin, const std::string &ArchName
   return Res;
 }
 
+// Returns the GNU build-id of an ELF object as a hex string.
+static bool getGNUBuildID(const ObjectFile *Obj, std::string &BuildID) {
+  if (!Obj->isELF())
+    return false;
+  for (const SectionRef &Section : Obj->sections()) {
+    StringRef Name;
+    Section.getName(Name);
+    if (Name != ".note.gnu.build-id")
+      continue;
+    StringRef Data;
+    if (Section.getContents(Data))
+      return false;
+    // Note header: namesz, descsz and type, followed by the name and the
+    // descriptor, each padded to 4 bytes.
+    DataExtractor DE(Data, Obj->isLittleEndian(), 0);
+    uint32_t Offset = 0;
+    if (!DE.isValidOffsetForDataOfSize(Offset, 12))
+      return false;
+    uint64_t NameSize = DE.getU32(&Offset);
+    uint64_t DescSize = DE.getU32(&Offset);
+    uint32_t Type = DE.getU32(&Offset);
+    const uint32_t NT_GNU_BUILD_ID = 3;
+    uint64_t DescOffset = Offset + ((NameSize + 3) & ~uint64_t(3));
+    if (Type != NT_GNU_BUILD_ID || DescSize == 0 ||
+        DescOffset + DescSize > Data.size())
+      return false;
+    BuildID.clear();
+    for (unsigned char C : Data.substr(DescOffset, DescSize)) {
+      BuildID += hexdigit(C >> 4, /*LowerCase=*/true);
+      BuildID += hexdigit(C & 0xf, /*LowerCase=*/true);
+    }
+    return true;
+  }
+  return false;
+}
+
+SymbolIndex *LLVMSymbolizer::getOrCreateSymbolIndex(ObjectFile *Obj) {
+  std::string BuildID;
+  if (Opts.SymbolIndexDir.empty() || !getGNUBuildID(Obj, BuildID))
+    return SymbolIndex::create(Obj);
+  SmallString<128> IndexPath(Opts.SymbolIndexDir);
+  sys::path::append(IndexPath, BuildID + ".symidx");
+  if (SymbolIndex *Index = SymbolIndex::load(IndexPath))
+    return Index;
+  SymbolIndex *Index = SymbolIndex::create(Obj);
+  // Failing to populate the cache is not an error: the index is simply
+  // rebuilt by the next run.
+  if (!sys::fs::create_directories(Opts.SymbolIndexDir))
+    Index->writeToFile(IndexPath);
+  return Index;
+}
+
 ModuleInfo *
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   ModuleMapTy::iterator I = Modules.find(ModuleName);
@@ -387,7 +591,8 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   }
   DIContext *Context = DIContext::getDWARFContext(DbgObj);
   assert(Context);
-  ModuleInfo *Info = new ModuleInfo(Obj, Context);
+  ModuleInfo *Info =
+      new ModuleInfo(Obj, Context, getOrCreateSymbolIndex(Obj));
   Modules.insert(make_pair(ModuleName, Info));
   return Info;
 }
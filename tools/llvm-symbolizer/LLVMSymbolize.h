@@ -17,6 +17,7 @@
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <map>
 #include <memory>
@@ -30,6 +31,7 @@ using namespace object;
 namespace symbolize {
 
 class ModuleInfo;
+class SymbolIndex;
 
 class LLVMSymbolizer {
 public:
@@ -39,13 +41,16 @@ public:
     bool PrintInlining : 1;
     bool Demangle : 1;
     std::string DefaultArch;
+    // Directory where symbol indexes are cached, keyed by build-id. Empty
+    // disables the on-disk cache.
+    std::string SymbolIndexDir;
     Options(bool UseSymbolTable = true,
             FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool PrintInlining = true, bool Demangle = true,
-            std::string DefaultArch = "")
+            std::string DefaultArch = "", std::string SymbolIndexDir = "")
         : UseSymbolTable(UseSymbolTable), PrintFunctions(PrintFunctions),
           PrintInlining(PrintInlining), Demangle(Demangle),
-          DefaultArch(DefaultArch) {}
+          DefaultArch(DefaultArch), SymbolIndexDir(SymbolIndexDir) {}
   };
 
   LLVMSymbolizer(const Options &Opts = Options()) : Opts(Opts) {}
@@ -70,6 +75,9 @@ private:
   /// \brief Returns a parsed object file for a given architecture in a
   /// universal binary (or the binary itself if it is an object file).
   ObjectFile *getObjectFileFromBinary(Binary *Bin, const std::string &ArchName);
+  /// \brief Returns the symbol index for \p Obj, loading it from (or storing
+  /// it to) the symbol index cache directory if one is configured.
+  SymbolIndex *getOrCreateSymbolIndex(ObjectFile *Obj);
 
   std::string printDILineInfo(DILineInfo LineInfo) const;
 
@@ -88,9 +96,60 @@ private:
   static const char kBadString[];
 };
 
+/// \brief A compact, sorted address index over the function and data symbols
+/// of an object file.
+///
+/// The index is a single flat buffer (a header, two entry arrays sorted by
+/// address and a string table) that is queried in place. An index written to
+/// disk can thus be memory-mapped and used directly, without reading the
+/// symbol table of the original object again.
+class SymbolIndex {
+public:
+  /// \brief Builds the index from the symbol table of \p Obj.
+  static SymbolIndex *create(ObjectFile *Obj);
+  /// \brief Loads an index previously written with writeToFile(). Returns
+  /// null if the file is missing or is not a valid index.
+  static SymbolIndex *load(StringRef Path);
+
+  /// \brief Writes the index to \p Path. The file is written under a unique
+  /// temporary name and renamed into place, so concurrent readers never see
+  /// a partially written index.
+  std::error_code writeToFile(StringRef Path) const;
+
+  bool lookup(SymbolRef::Type Type, uint64_t Address, StringRef &Name,
+              uint64_t &Addr, uint64_t &Size) const;
+
+private:
+  struct Header {
+    char Magic[8];
+    support::ulittle32_t Version;
+    support::ulittle32_t NumFunctions;
+    support::ulittle32_t NumObjects;
+    support::ulittle32_t StringTableSize;
+  };
+  struct Entry {
+    support::ulittle64_t Addr;
+    // If size is 0, assume that symbol occupies the whole memory range up to
+    // the following symbol.
+    support::ulittle64_t Size;
+    support::ulittle32_t NameOffset;
+    support::ulittle32_t NameSize;
+  };
+  static const char kMagic[8];
+  static const uint32_t kVersion = 1;
+
+  explicit SymbolIndex(MemoryBuffer *Buffer) : Buffer(Buffer) {}
+  bool parse();
+
+  std::unique_ptr<MemoryBuffer> Buffer;
+  ArrayRef<Entry> Functions;
+  ArrayRef<Entry> Objects;
+  StringRef Strings;
+};
+
 class ModuleInfo {
 public:
-  ModuleInfo(ObjectFile *Obj, DIContext *DICtx);
+  ModuleInfo(ObjectFile *Obj, DIContext *DICtx, SymbolIndex *Symbols);
 
   DILineInfo symbolizeCode(uint64_t ModuleOffset,
                            const LLVMSymbolizer::Options &Opts) const;
@@ -103,22 +162,9 @@ private:
   bool getNameFromSymbolTable(SymbolRef::Type Type, uint64_t Address,
                               std::string &Name, uint64_t &Addr,
                               uint64_t &Size) const;
-  void addSymbol(const SymbolRef &Symbol);
   ObjectFile *Module;
   std::unique_ptr<DIContext> DebugInfoContext;
-
-  struct SymbolDesc {
-    uint64_t Addr;
-    // If size is 0, assume that symbol occupies the whole memory range up to
-    // the following symbol.
-    uint64_t Size;
-    friend bool operator<(const SymbolDesc &s1, const SymbolDesc &s2) {
-      return s1.Addr < s2.Addr;
-    }
-  };
-  typedef std::map<SymbolDesc, StringRef> SymbolMapTy;
-  SymbolMapTy Functions;
-  SymbolMapTy Objects;
+  std::unique_ptr<SymbolIndex> Symbols;
 };
 
 } // namespace symbolize
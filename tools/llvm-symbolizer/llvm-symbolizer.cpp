@@ -23,9 +23,12 @@
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <tuple>
+#include <vector>
 
 using namespace llvm;
 using namespace symbolize;
@@ -61,6 +64,17 @@ ClBinaryName("obj", cl::init(""),
              cl::desc("Path to object file to be symbolized (if not provided, "
                       "object file should be specified for each input line)"));
 
+static cl::opt<std::string>
+ClSymbolIndexDir("symbol-index-dir", cl::init(""),
+                 cl::desc("Directory used to cache symbol table indexes of "
+                          "binaries, keyed by their build-id"));
+
+static cl::opt<bool>
+ClBatch("batch", cl::init(false),
+        cl::desc("Read all input before symbolizing. Repeated addresses are "
+                 "symbolized once, and each module is queried in address "
+                 "order"));
+
 static bool parseCommand(bool &IsData, std::string &ModuleName,
                          uint64_t &ModuleOffset) {
   const char *kDataCmd = "DATA ";
@@ -110,6 +124,52 @@ static bool parseCommand(bool &IsData, std::string &ModuleName,
   return true;
 }
 
+namespace {
+struct Command {
+  bool IsData;
+  std::string ModuleName;
+  uint64_t ModuleOffset;
+};
+}
+
+static bool commandLess(const Command *C1, const Command *C2) {
+  return std::tie(C1->ModuleName, C1->IsData, C1->ModuleOffset) <
+         std::tie(C2->ModuleName, C2->IsData, C2->ModuleOffset);
+}
+
+static bool commandEqual(const Command *C1, const Command *C2) {
+  return C1->ModuleName == C2->ModuleName && C1->IsData == C2->IsData &&
+         C1->ModuleOffset == C2->ModuleOffset;
+}
+
+// Symbolizes every command once per distinct (module, kind, offset), walking
+// each module in increasing address order, and prints the results in input
+// order.
+static void symbolizeBatch(LLVMSymbolizer &Symbolizer,
+                           const std::vector<Command> &Commands) {
+  std::vector<const Command *> Sorted;
+  Sorted.reserve(Commands.size());
+  for (const Command &C : Commands)
+    Sorted.push_back(&C);
+  std::sort(Sorted.begin(), Sorted.end(), commandLess);
+
+  std::vector<const std::string *> ResultFor(Commands.size());
+  std::vector<std::string> Results;
+  Results.reserve(Commands.size());
+  for (unsigned i = 0, e = Sorted.size(); i != e; ++i) {
+    const Command *C = Sorted[i];
+    if (i == 0 || !commandEqual(Sorted[i - 1], C))
+      Results.push_back(
+          C->IsData ? Symbolizer.symbolizeData(C->ModuleName, C->ModuleOffset)
+                    : Symbolizer.symbolizeCode(C->ModuleName, C->ModuleOffset));
+    ResultFor[C - &Commands[0]] = &Results.back();
+  }
+
+  for (const std::string *Result : ResultFor)
+    outs() << *Result << "\n";
+  outs().flush();
+}
+
 int main(int argc, char **argv) {
   // Print stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -118,12 +178,22 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClUseSymbolTable, ClPrintFunctions,
-                               ClPrintInlining, ClDemangle, ClDefaultArch);
+                               ClPrintInlining, ClDemangle, ClDefaultArch,
+                               ClSymbolIndexDir);
   LLVMSymbolizer Symbolizer(Opts);
 
   bool IsData = false;
   std::string ModuleName;
   uint64_t ModuleOffset;
+  if (ClBatch) {
+    std::vector<Command> Commands;
+    while (parseCommand(IsData, ModuleName, ModuleOffset)) {
+      Command C = { IsData, ModuleName, ModuleOffset };
+      Commands.push_back(C);
+    }
+    symbolizeBatch(Symbolizer, Commands);
+    return 0;
+  }
   while (parseCommand(IsData, ModuleName, ModuleOffset)) {
     std::string Result =
         IsData ? Symbolizer.symbolizeData(ModuleName, ModuleOffset)
@@ -167,5 +167,79 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, SlabReuseAfterFinalize) {
+  const uintptr_t SlabSize = 1 << 20;
+  std::unique_ptr<SectionMemoryManager> MemMgr(
+      new SectionMemoryManager(SlabSize));
+
+  uint8_t *code1 = MemMgr->allocateCodeSection(256, 0, 1, "");
+  uint8_t *data1 = MemMgr->allocateDataSection(256, 0, 2, "", true);
+  EXPECT_NE((uint8_t*)nullptr, code1);
+  EXPECT_NE((uint8_t*)nullptr, data1);
+  for (unsigned i = 0; i < 256; ++i) {
+    code1[i] = 1;
+    data1[i] = 2;
+  }
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+
+  // Later objects are placed in the same slabs, but never on a page which
+  // has already been made executable or read-only.
+  uint8_t *code2 = MemMgr->allocateCodeSection(256, 0, 3, "");
+  uint8_t *data2 = MemMgr->allocateDataSection(256, 0, 4, "", true);
+  EXPECT_NE((uint8_t*)nullptr, code2);
+  EXPECT_NE((uint8_t*)nullptr, data2);
+  EXPECT_LT((uintptr_t)(code2 - code1), SlabSize);
+  EXPECT_LT((uintptr_t)(data2 - data1), SlabSize);
+  EXPECT_GE((uintptr_t)(code2 - code1), (uintptr_t)256);
+  EXPECT_GE((uintptr_t)(data2 - data1), (uintptr_t)256);
+
+  // The new memory must still be writable.
+  for (unsigned i = 0; i < 256; ++i) {
+    code2[i] = 3;
+    data2[i] = 4;
+  }
+  for (unsigned i = 0; i < 256; ++i) {
+    EXPECT_EQ(1, code1[i]);
+    EXPECT_EQ(2, data1[i]);
+    EXPECT_EQ(3, code2[i]);
+    EXPECT_EQ(4, data2[i]);
+  }
+
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+}
+
+TEST(MCJITMemoryManagerTest, HugePageSlabs) {
+  std::unique_ptr<SectionMemoryManager> MemMgr(
+      new SectionMemoryManager(0, /*UseHugePages=*/true));
+
+  uint8_t *code[100];
+  for (unsigned i = 0; i < 100; ++i) {
+    code[i] = MemMgr->allocateCodeSection(1024, 0, i, "");
+    EXPECT_NE((uint8_t*)nullptr, code[i]);
+    for (unsigned j = 0; j < 1024; ++j)
+      code[i][j] = i;
+  }
+  for (unsigned i = 0; i < 100; ++i)
+    for (unsigned j = 0; j < 1024; ++j)
+      EXPECT_EQ((uint8_t)i, code[i][j]);
+
+  // The code slab is rounded up to 2 MB, so a large section still fits right
+  // after the small ones instead of getting a mapping of its own.
+  const uintptr_t Large = 1536 * 1024;
+  uint8_t *bigCode = MemMgr->allocateCodeSection(Large, 0, 100, "");
+  EXPECT_EQ(code[99] + 1024, bigCode);
+
+  // Data is not affected: the same request for data needs a new mapping.
+  uint8_t *data = MemMgr->allocateDataSection(1024, 0, 101, "", false);
+  uint8_t *bigData = MemMgr->allocateDataSection(Large, 0, 102, "", false);
+  EXPECT_NE((uint8_t*)nullptr, data);
+  EXPECT_NE(data + 1024, bigData);
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+}
+
 } // Namespace
 
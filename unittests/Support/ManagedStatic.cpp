@@ -47,7 +47,10 @@ TEST(Initialize, MultipleThreads) {
   void *p1 = test1::allocate_stack(a1);
   void *p2 = test1::allocate_stack(a2);
 
-  llvm_start_multithreaded();
+  // A ThreadPool created by an earlier test may have started it already.
+  bool WasMultithreaded = llvm_is_multithreaded();
+  if (!WasMultithreaded)
+    llvm_start_multithreaded();
   pthread_t t1, t2;
   pthread_create(&t1, &a1, test1::helper, nullptr);
   pthread_create(&t2, &a2, test1::helper, nullptr);
@@ -55,7 +58,8 @@ TEST(Initialize, MultipleThreads) {
   pthread_join(t2, nullptr);
   free(p1);
   free(p2);
-  llvm_stop_multithreaded();
+  if (!WasMultithreaded)
+    llvm_stop_multithreaded();
 }
 #endif
 
@@ -153,4 +153,42 @@ TEST_F(RegexTest, MoveAssign) {
   EXPECT_TRUE(r2.match("916"));
 }
 
+TEST_F(RegexTest, LiteralPrefix) {
+  // A match can only start where the leading literal does.
+  Regex r1("(ab)c[0-9]+");
+  SmallVector<StringRef, 2> Matches;
+  EXPECT_TRUE(r1.match("abxab abc12 abc3", &Matches));
+  EXPECT_EQ("abc12", Matches[0].str());
+  EXPECT_EQ("ab", Matches[1].str());
+  EXPECT_FALSE(r1.match("abcabcab"));
+
+  // Skipping ahead to the prefix must not make its position look like the
+  // start of the string.
+  Regex r2("b^");
+  EXPECT_FALSE(r2.match("ab"));
+  Regex r3("a[[:>:]].*");
+  EXPECT_TRUE(r3.match("xba"));
+  EXPECT_FALSE(r3.match("xab"));
+}
+
+TEST_F(RegexTest, LongSubject) {
+  // Subjects this long go through the matcher's transition cache.
+  std::string Buffer;
+  for (unsigned i = 0; i != 1000; ++i)
+    Buffer += "movl %eax, (%esp)\n";
+  std::string Tail = "addl $12, %esp\n";
+
+  SmallVector<StringRef, 2> Matches;
+  Regex r1("[a-z]+l \\$([0-9]+), %esp", Regex::Newline);
+  EXPECT_FALSE(r1.match(Buffer));
+  EXPECT_TRUE(r1.match(Buffer + Tail, &Matches));
+  EXPECT_EQ("addl $12, %esp", Matches[0].str());
+  EXPECT_EQ("12", Matches[1].str());
+
+  Regex r2("^add", Regex::Newline);
+  EXPECT_TRUE(r2.match(Buffer + Tail));
+  Regex r3("^add");
+  EXPECT_FALSE(r3.match(Buffer + Tail));
+}
+
 }
@@ -0,0 +1,68 @@
+//========- unittests/Support/ThreadPoolTest.cpp - ThreadPool.h tests -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ThreadPoolTest, AsyncBarrier) {
+  std::atomic_int Count(0);
+  {
+    ThreadPool Pool(4);
+    for (int i = 0; i < 100; ++i)
+      Pool.async([&Count] { ++Count; });
+    Pool.wait();
+    EXPECT_EQ(100, Count);
+  }
+  EXPECT_EQ(100, Count);
+}
+
+TEST(ThreadPoolTest, WaitIsReusable) {
+  std::atomic_int Count(0);
+  ThreadPool Pool(2);
+  Pool.async([&Count] { ++Count; });
+  Pool.wait();
+  EXPECT_EQ(1, Count);
+  Pool.async([&Count] { ++Count; });
+  Pool.async([&Count] { ++Count; });
+  Pool.wait();
+  EXPECT_EQ(3, Count);
+}
+
+TEST(ThreadPoolTest, DestructorWaits) {
+  std::atomic_int Count(0);
+  {
+    ThreadPool Pool(2);
+    for (int i = 0; i < 10; ++i)
+      Pool.async([&Count] { ++Count; });
+  }
+  EXPECT_EQ(10, Count);
+}
+
+TEST(ThreadPoolTest, ThreadCount) {
+#if LLVM_ENABLE_THREADS
+  EXPECT_EQ(3u, ThreadPool::getThreadCount(3));
+#endif
+  EXPECT_LE(1u, ThreadPool::getThreadCount());
+}
+
+TEST(ThreadPoolTest, StartsMultithreadedMode) {
+  ThreadPool Pool(2);
+#if LLVM_ENABLE_THREADS
+  EXPECT_TRUE(llvm_is_multithreaded());
+#endif
+}
+
+}
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <cctype>
 #include <map>
+#include <memory>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -83,6 +84,15 @@ class Pattern {
   /// RegEx - If non-empty, this is a regex pattern.
   std::string RegExStr;
 
+  /// CompiledRegEx - RegExStr compiled once, for patterns without variable
+  /// uses. Shared by the copies of the pattern.
+  std::shared_ptr<Regex> CompiledRegEx;
+
+  /// LiteralPrefix - The fixed text a regex pattern starts with. A match can
+  /// only start where this occurs, so the regex engine is started on the line
+  /// of its first occurrence.
+  StringRef LiteralPrefix;
+
   /// \brief Contains the number of line this pattern is in.
   unsigned LineNumber;
 
@@ -185,6 +195,9 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     return false;
   }
 
+  LiteralPrefix = PatternStr.substr(0, std::min(PatternStr.find("{{"),
+                                                 PatternStr.find("[[")));
+
   // Paren value #0 is for the fully matched string.  Any new parenthesized
   // values add from there.
   unsigned CurParen = 1;
@@ -316,6 +329,9 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     PatternStr = PatternStr.substr(FixedMatchEnd);
   }
 
+  if (VariableUses.empty())
+    CompiledRegEx = std::make_shared<Regex>(RegExStr, Regex::Newline);
+
   return false;
 }
 
@@ -414,9 +430,26 @@ size_t Pattern::Match(StringRef Buffer, size_t &MatchLen,
   }
 
 
+  // Skip ahead to the line where a match could first start. Starting at the
+  // beginning of that line keeps the meaning of anchors in the regex.
+  StringRef SearchBuffer = Buffer;
+  if (!LiteralPrefix.empty()) {
+    size_t PrefixLoc = Buffer.find(LiteralPrefix);
+    if (PrefixLoc == StringRef::npos)
+      return StringRef::npos;
+    size_t LineStart = Buffer.rfind('\n', PrefixLoc);
+    if (LineStart != StringRef::npos)
+      SearchBuffer = Buffer.substr(LineStart + 1);
+  }
+
   SmallVector<StringRef, 4> MatchInfo;
-  if (!Regex(RegExToMatch, Regex::Newline).match(Buffer, &MatchInfo))
+  if (CompiledRegEx) {
+    if (!CompiledRegEx->match(SearchBuffer, &MatchInfo))
+      return StringRef::npos;
+  } else if (!Regex(RegExToMatch, Regex::Newline).match(SearchBuffer,
+                                                         &MatchInfo)) {
     return StringRef::npos;
+  }
 
   // Successful regex match.
   assert(!MatchInfo.empty() && "Didn't get any match");
@@ -2230,6 +2230,17 @@ CodeGenDAGPatterns::~CodeGenDAGPatterns() {
     delete I->second;
 }
 
+CodeGenDAGPatterns &llvm::getSharedDAGPatterns(RecordKeeper &Records) {
+  // Intentionally leaked: the records the patterns refer to may be gone by
+  // the time it could be destroyed.
+  static RecordKeeper *SharedRecords = nullptr;
+  static CodeGenDAGPatterns *Shared = nullptr;
+  if (SharedRecords != &Records) {
+    Shared = new CodeGenDAGPatterns(Records);
+    SharedRecords = &Records;
+  }
+  return *Shared;
+}
 
 Record *CodeGenDAGPatterns::getSDNodeNamed(const std::string &Name) const {
   Record *N = Records.getDef(Name);
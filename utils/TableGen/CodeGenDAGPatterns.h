@@ -838,6 +838,12 @@ private:
                                    TreePatternNode*> &InstResults,
                                    std::vector<Record*> &InstImpResults);
 };
+
+/// getSharedDAGPatterns - Return the CodeGenDAGPatterns for Records, computing
+/// it on first use.  Pattern inference is expensive, and when several
+/// backends run over the same records (tblgen -write-output) they can share
+/// its result rather than repeating it.
+CodeGenDAGPatterns &getSharedDAGPatterns(RecordKeeper &Records);
 } // end namespace llvm
 
 #endif
@@ -342,6 +342,13 @@ void CodeGenTarget::reverseBitsForLittleEndianEncoding() {
   if (!isLittleEndianEncoding())
     return;
 
+  // Every backend that runs over the same records (tblgen -write-output)
+  // asks for this, but the bits must only be reversed once.
+  static const RecordKeeper *ReversedRecords = nullptr;
+  if (ReversedRecords == &Records)
+    return;
+  ReversedRecords = &Records;
+
   std::vector<Record*> Insts = Records.getAllDerivedDefinitions("Instruction");
   for (std::vector<Record*>::iterator I = Insts.begin(), E = Insts.end();
        I != E; ++I) {
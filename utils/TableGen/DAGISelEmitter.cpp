@@ -24,9 +24,9 @@ namespace {
 /// DAGISelEmitter - The top-level class which coordinates construction
 /// and emission of the instruction selector.
 class DAGISelEmitter {
-  CodeGenDAGPatterns CGP;
+  CodeGenDAGPatterns &CGP;
 public:
-  explicit DAGISelEmitter(RecordKeeper &R) : CGP(R) {}
+  explicit DAGISelEmitter(RecordKeeper &R) : CGP(getSharedDAGPatterns(R)) {}
   void run(raw_ostream &OS);
 };
 } // End anonymous namespace
@@ -91,8 +91,8 @@ namespace {
   Class("class", cl::desc("Print Enum list for this class"),
           cl::value_desc("class name"));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+bool runAction(ActionType A, raw_ostream &OS, RecordKeeper &Records) {
+  switch (A) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
     break;
@@ -171,6 +171,22 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return runAction(Action, OS, Records);
+}
+
+bool LLVMTableGenAction(raw_ostream &OS, RecordKeeper &Records,
+                        StringRef Name) {
+  cl::parser<ActionType> &Parser = Action.getParser();
+  if (Parser.findOption(Name.str().c_str()) == Parser.getNumOptions()) {
+    PrintError("unknown action '" + Name + "'");
+    return true;
+  }
+  ActionType A;
+  Parser.parse(Action, Name, StringRef(), A);
+  return runAction(A, OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
@@ -178,7 +194,7 @@ int main(int argc, char **argv) {
   PrettyStackTraceProgram X(argc, argv);
   cl::ParseCommandLineOptions(argc, argv);
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  return TableGenMain(argv[0], &LLVMTableGenMain, &LLVMTableGenAction);
 }
 
 #ifdef __has_feature